@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <time.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static struct timespec start_time;
+
+static unsigned long long now_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (start_time.tv_sec == 0 && start_time.tv_nsec == 0)
+    {
+        start_time = now;
+    }
+
+    return (unsigned long long)(now.tv_sec - start_time.tv_sec) * 1000000 + (now.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+unsigned long millis(void)
+{
+    return now_us() / 1000;
+}
+
+unsigned long micros(void)
+{
+    return now_us();
+}
+
+void delay(unsigned long ms)
+{
+    struct timespec wait = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+    nanosleep(&wait, NULL);
+}
+
+String::String(float number, unsigned int decimals)
+{
+    char buff[32];
+    snprintf(buff, sizeof(buff), "%.*f", decimals, number);
+    value = buff;
+}
+
+size_t HardwareSerial::print(const char* text)
+{
+    return fputs(text, stdout) < 0 ? 0 : strlen(text);
+}
+
+size_t HardwareSerial::print(char character)
+{
+    return fputc(character, stdout) < 0 ? 0 : 1;
+}
+
+size_t HardwareSerial::print(int number)
+{
+    return ::printf("%d", number);
+}
+
+size_t HardwareSerial::print(unsigned int number)
+{
+    return ::printf("%u", number);
+}
+
+size_t HardwareSerial::print(long number)
+{
+    return ::printf("%ld", number);
+}
+
+size_t HardwareSerial::print(unsigned long number)
+{
+    return ::printf("%lu", number);
+}
+
+size_t HardwareSerial::print(double number)
+{
+    return ::printf("%.2f", number);
+}
+
+size_t HardwareSerial::printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+    return written < 0 ? 0 : written;
+}
+
+void EspClass::restart()
+{
+    ::printf("ESP.restart() called, exiting\n");
+    fflush(stdout);
+    exit(0);
+}
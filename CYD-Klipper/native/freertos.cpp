@@ -0,0 +1,57 @@
+#include <freertos/queue.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct QueueDefinition
+{
+    unsigned char* items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = (QueueHandle_t)calloc(1, sizeof(QueueDefinition));
+    queue->items = (unsigned char*)malloc(length * item_size);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait)
+{
+    if (queue->count == queue->length)
+    {
+        return pdFALSE;
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t wait)
+{
+    if (queue->count == 0)
+    {
+        return pdFALSE;
+    }
+
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait)
+{
+    if (xQueuePeek(queue, item, wait) != pdTRUE)
+    {
+        return pdFALSE;
+    }
+
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * Just enough of the Arduino core to build the UI on the host, see native/main.cpp.
+ * LVGL's C sources include this too, for millis() through LV_TICK_CUSTOM_INCLUDE.
+ */
+
+#include <stdint.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+
+#ifdef __cplusplus
+}
+
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+class String
+{
+    private:
+        std::string value;
+
+    public:
+        String(const char* text = "") : value(text) {}
+        String(const std::string& text) : value(text) {}
+        String(int number) : value(std::to_string(number)) {}
+        String(unsigned int number) : value(std::to_string(number)) {}
+        String(long number) : value(std::to_string(number)) {}
+        String(unsigned long number) : value(std::to_string(number)) {}
+        String(float number, unsigned int decimals = 2);
+        String(double number, unsigned int decimals = 2) : String((float)number, decimals) {}
+
+        const char* c_str() const { return value.c_str(); }
+        unsigned int length() const { return value.length(); }
+        String operator+(const String& other) const { return String(value + other.value); }
+        String& operator+=(const String& other) { value += other.value; return *this; }
+        bool operator==(const String& other) const { return value == other.value; }
+        bool operator!=(const String& other) const { return value != other.value; }
+};
+
+class HardwareSerial
+{
+    public:
+        void begin(unsigned long baud) {}
+        size_t print(const char* text);
+        size_t print(const String& text) { return print(text.c_str()); }
+        size_t print(char character);
+        size_t print(int number);
+        size_t print(unsigned int number);
+        size_t print(long number);
+        size_t print(unsigned long number);
+        size_t print(double number);
+        size_t println() { return print("\n"); }
+
+        template <typename T>
+        size_t println(T value)
+        {
+            return print(value) + println();
+        }
+
+        size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+    public:
+        // Ends the program, there is nothing to restart into
+        void restart();
+};
+
+extern EspClass ESP;
+
+#endif // __cplusplus
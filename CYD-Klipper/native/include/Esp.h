@@ -0,0 +1,4 @@
+#pragma once
+
+// Part of the Arduino.h shim on the host
+#include "Arduino.h"
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Nothing is stored on the host, every run starts from the defaults of load_global_config()
+class Preferences
+{
+    public:
+        bool begin(const char* name, bool read_only = false) { return false; }
+        void end() {}
+        bool clear() { return true; }
+        bool remove(const char* key) { return true; }
+        bool isKey(const char* key) { return false; }
+        size_t getBytes(const char* key, void* buffer, size_t length) { return 0; }
+        size_t putBytes(const char* key, const void* data, size_t length) { return length; }
+};
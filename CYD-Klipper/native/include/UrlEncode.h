@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Only requests to a printer encode their arguments, the host build has no network
+inline String urlEncode(String text)
+{
+    return text;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+typedef int esp_err_t;
+typedef void (*shutdown_handler_t)(void);
+
+// The host never restarts, ESP.restart() ends the program instead
+static inline esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler)
+{
+    return 0;
+}
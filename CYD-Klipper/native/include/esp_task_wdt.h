@@ -0,0 +1,6 @@
+#pragma once
+
+// printer_integration.hpp gets BIT() through this header on the device
+#ifndef BIT
+#define BIT(nr) (1UL << (nr))
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+/*
+ * Queues for a single task. Nothing else can fill or drain a queue meanwhile, so nothing ever blocks:
+ * a send to a full queue and a receive from an empty one fail right away, whatever the wait.
+ */
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t wait);
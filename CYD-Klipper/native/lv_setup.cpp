@@ -0,0 +1,83 @@
+#include "../src/core/lv_setup.h"
+#include "../src/conf/global_config.h"
+#include "lvgl.h"
+
+// Host version of src/core/lv_setup.cpp: no touch, no calibration and the screen never sleeps
+
+static unsigned long long redrawn_px_total = 0;
+
+static void lv_monitor_redrawn_area(lv_disp_drv_t * disp_drv, uint32_t time, uint32_t px)
+{
+    redrawn_px_total += px;
+}
+
+void set_screen_brightness()
+{
+}
+
+void set_screen_timer_period()
+{
+}
+
+void screen_timer_wake()
+{
+}
+
+void screen_timer_start()
+{
+}
+
+void screen_timer_stop()
+{
+}
+
+void set_color_scheme()
+{
+    PrinterConfiguration *config = &global_config.printer_config[global_config.printer_index];
+    lv_disp_t *dispp = lv_disp_get_default();
+    lv_color_t main_color = {0};
+    ColorDefinition color_def = color_defs[config->color_scheme];
+
+    if (color_def.primary_color_light > 0){
+        main_color = lv_palette_lighten(color_def.primary_color, color_def.primary_color_light);
+    }
+    else if (color_def.primary_color_light < 0) {
+        main_color = lv_palette_darken(color_def.primary_color, color_def.primary_color_light * -1);
+    }
+    else {
+        main_color = lv_palette_main(color_def.primary_color);
+    }
+
+    lv_theme_t *theme = lv_theme_default_init(dispp, main_color, lv_palette_main(color_def.secondary_color), !config->light_mode, &CYD_SCREEN_FONT);
+    lv_disp_set_theme(dispp, theme);
+}
+
+void lv_setup()
+{
+    set_color_scheme();
+    lv_disp_get_default()->driver->monitor_cb = lv_monitor_redrawn_area;
+    lv_png_init();
+}
+
+void lv_calibrate_if_needed()
+{
+}
+
+bool is_screen_asleep()
+{
+    return false;
+}
+
+unsigned long long get_redrawn_px_total()
+{
+    return redrawn_px_total;
+}
+
+void print_power_stats()
+{
+}
+
+unsigned int lv_handler()
+{
+    return lv_timer_handler();
+}
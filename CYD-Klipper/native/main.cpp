@@ -0,0 +1,43 @@
+#include <Arduino.h>
+#include "../src/conf/global_config.h"
+#include "../src/core/screen_driver.h"
+#include "../src/core/lv_setup.h"
+#include "../src/core/printer_integration.hpp"
+#include "../src/ui/nav_buttons.h"
+#include "../src/ui/ui_benchmark.h"
+#include "lvgl.h"
+#include "mock_printer.h"
+
+/*
+ * Runs the UI benchmark on the host: the panels of src/ui are drawn into a memory framebuffer
+ * and fed by a mocked printer. Run with 'pio run -e native-ui -t exec'.
+ * Times are of the host, compare them between builds rather than with the device.
+ * LVGL heap usage is higher than on the device, as pointers take 8 bytes here.
+ */
+int main()
+{
+    load_global_config();
+
+    PrinterConfiguration* config = &global_config.printer_config[0];
+    config->setup_complete = true;
+    config->ip_configured = true;
+    config->printer_type = PrinterTypeKlipper;
+    strcpy(config->printer_name, "Benchmark");
+
+    screen_setup();
+    lv_setup();
+
+    BasePrinter** printers = (BasePrinter**)malloc(sizeof(BasePrinter*));
+    printers[0] = new MockPrinter(0);
+    initialize_printers(printers, 1);
+    printers[0]->connect();
+    printers[0]->fetch();
+    apply_printer_updates();
+
+    nav_style_setup();
+    nav_buttons_setup(PANEL_PROGRESS);
+    lv_refr_now(NULL);
+
+    ui_benchmark_run();
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "mock_printer.h"
+#include <Arduino.h>
+
+MockPrinter::MockPrinter(unsigned char index) : BasePrinter(index)
+{
+    supported_features = PrinterFeatureRestart
+        | PrinterFeatureFirmwareRestart
+        | PrinterFeatureHome
+        | PrinterFeatureDisableSteppers
+        | PrinterFeaturePause
+        | PrinterFeatureResume
+        | PrinterFeatureStop
+        | PrinterFeatureEmergencyStop
+        | PrinterFeatureExtrude
+        | PrinterFeatureRetract
+        | PrinterFeatureCooldown;
+
+    supported_temperature_devices = PrinterTemperatureDeviceBed | PrinterTemperatureDeviceNozzle1;
+}
+
+bool MockPrinter::move_printer(const char* axis, float amount, bool relative)
+{
+    return true;
+}
+
+bool MockPrinter::execute_feature(PrinterFeatures feature)
+{
+    return true;
+}
+
+bool MockPrinter::connect()
+{
+    printer_data.state = PrinterStatePrinting;
+    printer_data.state_message = strdup("Printing");
+    printer_data.print_filename = strdup("benchmark_cube_0.2mm_PLA_1h2m.gcode");
+    printer_data.homed_axis = true;
+    printer_data.absolute_coords = true;
+    printer_data.can_extrude = true;
+    printer_data.temperatures[PrinterTemperatureDeviceIndexNozzle1] = 210;
+    printer_data.target_temperatures[PrinterTemperatureDeviceIndexNozzle1] = 210;
+    printer_data.temperatures[PrinterTemperatureDeviceIndexBed] = 60;
+    printer_data.target_temperatures[PrinterTemperatureDeviceIndexBed] = 60;
+    printer_data.remaining_time_s = 3600;
+    printer_data.fan_speed = 1;
+    printer_data.speed_mult = 1;
+    printer_data.extrude_mult = 1;
+    printer_data.total_layers = 100;
+    printer_data.pressure_advance = 0.04f;
+    printer_data.smooth_time = 0.04f;
+    printer_data.feedrate_mm_per_s = 60;
+    return true;
+}
+
+bool MockPrinter::fetch()
+{
+    step_count++;
+    printer_data.temperatures[PrinterTemperatureDeviceIndexNozzle1] = 208 + step_count % 5;
+    printer_data.temperatures[PrinterTemperatureDeviceIndexBed] = 59 + step_count % 3;
+    printer_data.position[0] = 100 + step_count % 50;
+    printer_data.position[1] = 100 - step_count % 50;
+    printer_data.position[2] = 0.2f * (step_count / 10);
+    printer_data.elapsed_time_s += 1;
+    printer_data.printed_time_s += 1;
+    printer_data.remaining_time_s = printer_data.remaining_time_s > 1 ? printer_data.remaining_time_s - 1 : 3600;
+    printer_data.print_progress = (step_count % 3600) / 3600.0f;
+    printer_data.filament_used_mm += 3;
+    printer_data.current_layer = step_count / 10 % printer_data.total_layers;
+    AnnouncePrinterData();
+    return true;
+}
+
+PrinterDataMinimal MockPrinter::fetch_min()
+{
+    PrinterDataMinimal data = {};
+    data.state = printer_data.state;
+    data.print_progress = printer_data.print_progress;
+    data.success = true;
+    return data;
+}
+
+void MockPrinter::disconnect()
+{
+}
+
+Macros MockPrinter::get_macros()
+{
+    Macros macros = {0};
+    macros.macros = (char**)malloc(sizeof(char*) * MOCK_PRINTER_MACRO_COUNT);
+    macros.count = MOCK_PRINTER_MACRO_COUNT;
+    macros.success = true;
+
+    for (int i = 0; i < MOCK_PRINTER_MACRO_COUNT; i++)
+    {
+        char name[24];
+        sprintf(name, "MACRO_%02d", i);
+        macros.macros[i] = strdup(name);
+    }
+
+    return macros;
+}
+
+int MockPrinter::get_macros_count()
+{
+    return MOCK_PRINTER_MACRO_COUNT;
+}
+
+bool MockPrinter::execute_macro(const char* macro)
+{
+    return true;
+}
+
+PowerDevices MockPrinter::get_power_devices()
+{
+    PowerDevices devices = {0};
+    return devices;
+}
+
+int MockPrinter::get_power_devices_count()
+{
+    return 0;
+}
+
+bool MockPrinter::set_power_device_state(const char* device_name, bool state)
+{
+    return true;
+}
+
+Files MockPrinter::get_files()
+{
+    Files files = {0};
+    files.available_files = (char**)malloc(sizeof(char*) * MOCK_PRINTER_FILE_COUNT);
+    files.count = MOCK_PRINTER_FILE_COUNT;
+    files.success = true;
+    files.names_borrowed = true;
+
+    for (int i = 0; i < MOCK_PRINTER_FILE_COUNT; i++)
+    {
+        sprintf(file_names[i], "benchmark_part_%03d_0.2mm_PLA_%dh%02dm.gcode", i, i % 5, i % 60);
+        files.available_files[i] = file_names[i];
+    }
+
+    return files;
+}
+
+bool MockPrinter::start_file(const char* filename)
+{
+    return true;
+}
+
+Thumbnail MockPrinter::get_32_32_png_image_thumbnail(const char* gcode_filename)
+{
+    Thumbnail thumbnail = {0};
+    return thumbnail;
+}
+
+bool MockPrinter::set_target_temperature(PrinterTemperatureDevice device, unsigned int temperature)
+{
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../src/core/printer_integration.hpp"
+
+// Files and macros the mocked printer reports, enough to fill a few screens of rows
+#define MOCK_PRINTER_FILE_COUNT 200
+#define MOCK_PRINTER_MACRO_COUNT 24
+
+/*
+ * A printer in the middle of a print that never talks to the network.
+ * Every fetch() moves the print along by a second and announces the new data.
+ */
+class MockPrinter : public BasePrinter
+{
+    private:
+        int step_count{};
+        // Lent out by get_files, like the Klipper file index
+        char file_names[MOCK_PRINTER_FILE_COUNT][64];
+
+    public:
+        bool move_printer(const char* axis, float amount, bool relative);
+        bool execute_feature(PrinterFeatures feature);
+        bool connect();
+        bool fetch();
+        PrinterDataMinimal fetch_min();
+        void disconnect();
+        Macros get_macros();
+        int get_macros_count();
+        bool execute_macro(const char* macro);
+        PowerDevices get_power_devices();
+        int get_power_devices_count();
+        bool set_power_device_state(const char* device_name, bool state);
+        Files get_files();
+        bool start_file(const char* filename);
+        Thumbnail get_32_32_png_image_thumbnail(const char* gcode_filename);
+        bool set_target_temperature(PrinterTemperatureDevice device, unsigned int temperature);
+
+        MockPrinter(unsigned char index);
+};
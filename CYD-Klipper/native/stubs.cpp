@@ -0,0 +1,98 @@
+#include <Arduino.h>
+#include "../src/core/data_setup.h"
+#include "../src/core/semaphore.h"
+#include "../src/core/reconfigure.h"
+#include "../src/core/printer_integration.hpp"
+#include "../src/ui/main_ui.h"
+#include "../src/ui/ota_setup.h"
+
+// The host build runs everything on one task and has no network. Only what the UI calls is kept, doing nothing
+
+void data_loop(unsigned int idle_ms)
+{
+    apply_printer_updates();
+}
+
+void data_setup()
+{
+}
+
+void data_poll_now()
+{
+}
+
+void data_pause()
+{
+}
+
+void data_resume()
+{
+}
+
+void data_recreate_printers()
+{
+}
+
+void semaphore_init()
+{
+}
+
+BasePrinter* freeze_request_thread()
+{
+    return get_current_printer();
+}
+
+void unfreeze_request_thread()
+{
+}
+
+void freeze_printer_requests(BasePrinter* printer)
+{
+}
+
+void unfreeze_printer_requests(BasePrinter* printer)
+{
+}
+
+void reconfigure_request(ReconfigureClass what)
+{
+}
+
+void reconfigure_loop()
+{
+}
+
+void reconfigure_print_timings()
+{
+}
+
+void check_if_screen_needs_to_be_disabled()
+{
+}
+
+String ota_new_version_name()
+{
+    return String();
+}
+
+bool ota_has_update()
+{
+    return false;
+}
+
+void ota_start_download()
+{
+}
+
+void ota_status_text(char * buff)
+{
+    buff[0] = '\0';
+}
+
+void ota_init()
+{
+}
+
+void ota_loop()
+{
+}
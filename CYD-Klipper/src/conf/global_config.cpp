@@ -1,6 +1,8 @@
 #include <Preferences.h>
 #include "global_config.h"
 #include "lvgl.h"
+#include <esp_system.h>
+#include <stddef.h>
 
 GlobalConfig global_config = {0};
 TemporaryConfig temporary_config = {0};
@@ -16,29 +18,245 @@ ColorDefinition color_defs[] = {
     {LV_PALETTE_PURPLE, 0, LV_PALETTE_CYAN},
 };
 
-void write_global_config()
+typedef struct
+{
+    unsigned int requests;
+    unsigned int flushes;
+    unsigned int sections_written;
+    // Estimate of the NVS entries rewritten, including their headers
+    unsigned int bytes_written;
+} ConfigWriteStats;
+
+// Settings are stored as one NVS key per section, so an edit only rewrites the section it touched.
+// The general settings are everything outside printer_config, the printers have a key per slot.
+#define SECTION_GLOBAL_HEAD_SIZE offsetof(GlobalConfig, printer_config)
+#define SECTION_GLOBAL_TAIL_START (offsetof(GlobalConfig, printer_config) + sizeof(((GlobalConfig*)0)->printer_config))
+#define SECTION_GLOBAL_SIZE (SECTION_GLOBAL_HEAD_SIZE + sizeof(GlobalConfig) - SECTION_GLOBAL_TAIL_START)
+
+// Contents of flash as far as we know, edits are found by comparing against it
+static GlobalConfig persisted_config = {0};
+static bool config_dirty = false;
+static unsigned long config_dirty_since = 0;
+static unsigned long config_changed_at = 0;
+static ConfigWriteStats write_stats = {0};
+
+static void printer_section_key(int index, char* key)
+{
+    sprintf(key, "printer%d", index);
+}
+
+static void pack_global_section(const GlobalConfig* config, unsigned char* out)
+{
+    memcpy(out, config, SECTION_GLOBAL_HEAD_SIZE);
+    memcpy(out + SECTION_GLOBAL_HEAD_SIZE, (const unsigned char*)config + SECTION_GLOBAL_TAIL_START, sizeof(GlobalConfig) - SECTION_GLOBAL_TAIL_START);
+}
+
+// A section saved by an older build can be shorter, fields appended since keep their defaults
+static void unpack_global_section(GlobalConfig* config, const unsigned char* in, size_t length)
+{
+    memcpy(config, in, min(length, (size_t)SECTION_GLOBAL_HEAD_SIZE));
+
+    if (length > SECTION_GLOBAL_HEAD_SIZE)
+    {
+        memcpy((unsigned char*)config + SECTION_GLOBAL_TAIL_START, in + SECTION_GLOBAL_HEAD_SIZE, length - SECTION_GLOBAL_HEAD_SIZE);
+    }
+}
+
+// NVS stores a blob as an index entry plus a header and 32 byte data entries, this is what a write costs in flash
+static unsigned int flash_bytes_for_blob(size_t length)
+{
+    return (2 + (length + 31) / 32) * 32;
+}
+
+static bool put_section(Preferences& preferences, const char* key, const void* data, size_t length)
 {
+    // NVS writes the new entry before it drops the old one, a reset halfway through leaves the previous value intact
+    if (preferences.putBytes(key, data, length) != length)
+    {
+        LOG_F(("Config: Writing section %s failed\n", key))
+        return false;
+    }
+
+    write_stats.sections_written++;
+    write_stats.bytes_written += flash_bytes_for_blob(length);
+    return true;
+}
+
+// all writes every section, also those that look unchanged. Returns false when a section failed to write
+static bool flush_global_config(bool all = false)
+{
+    bool written = true;
+    unsigned char packed[SECTION_GLOBAL_SIZE];
+    unsigned char persisted_packed[SECTION_GLOBAL_SIZE];
+    pack_global_section(&global_config, packed);
+    pack_global_section(&persisted_config, persisted_packed);
+
     Preferences preferences;
     preferences.begin("global_config", false);
-    preferences.putBytes("global_config", &global_config, sizeof(global_config));
+
+    if (all || memcmp(packed, persisted_packed, SECTION_GLOBAL_SIZE) != 0)
+    {
+        if (put_section(preferences, "global", packed, SECTION_GLOBAL_SIZE))
+        {
+            unpack_global_section(&persisted_config, packed, SECTION_GLOBAL_SIZE);
+        }
+        else
+        {
+            written = false;
+        }
+    }
+
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++)
+    {
+        if (all || memcmp(&global_config.printer_config[i], &persisted_config.printer_config[i], sizeof(PrinterConfiguration)) != 0)
+        {
+            char key[12];
+            printer_section_key(i, key);
+
+            if (put_section(preferences, key, &global_config.printer_config[i], sizeof(PrinterConfiguration)))
+            {
+                memcpy(&persisted_config.printer_config[i], &global_config.printer_config[i], sizeof(PrinterConfiguration));
+            }
+            else
+            {
+                written = false;
+            }
+        }
+    }
+
     preferences.end();
+
+    // A section that failed to write is tried again with the next save
+    config_dirty = false;
+    write_stats.flushes++;
+    return written;
 }
 
-void verify_version()
+// Also runs on ESP.restart(), most settings changes restart right after saving
+static void flush_on_shutdown()
 {
-    Preferences preferences;
-    if (!preferences.begin("global_config", false))
+    write_global_config_now();
+}
+
+void write_global_config()
+{
+    unsigned long now = millis();
+
+    if (!config_dirty)
+    {
+        config_dirty = true;
+        config_dirty_since = now;
+    }
+
+    config_changed_at = now;
+    write_stats.requests++;
+}
+
+void write_global_config_now()
+{
+    if (config_dirty)
+    {
+        flush_global_config();
+    }
+}
+
+void global_config_loop()
+{
+    if (!config_dirty)
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+
+    if (now - config_changed_at >= CONFIG_WRITE_DELAY_MS || now - config_dirty_since >= CONFIG_WRITE_MAX_DELAY_MS)
+    {
+        flush_global_config();
+    }
+}
+
+void global_config_print_stats()
+{
+    unsigned long uptime_s = max(millis() / 1000, 1UL);
+    Serial.printf("%u saves requested, %u written to flash as %u sections, %u bytes\n",
+        write_stats.requests, write_stats.flushes, write_stats.sections_written, write_stats.bytes_written);
+    Serial.printf("%llu bytes per day at this rate, a full rewrite costs %u bytes\n",
+        (unsigned long long)write_stats.bytes_written * 86400 / uptime_s,
+        flash_bytes_for_blob(SECTION_GLOBAL_SIZE) + PRINTER_CONFIG_COUNT * flash_bytes_for_blob(sizeof(PrinterConfiguration)));
+    Serial.printf("Unsaved changes: %s\n", config_dirty ? "yes" : "no");
+}
+
+// Reads the sections into global_config. Returns false when nothing usable is stored
+static bool read_sections(Preferences& preferences)
+{
+    if (!preferences.isKey("global"))
+    {
+        return false;
+    }
+
+    unsigned char packed[SECTION_GLOBAL_SIZE] = {0};
+    size_t length = preferences.getBytes("global", packed, SECTION_GLOBAL_SIZE);
+    LOG_F(("Config version: %d\n", length > 0 ? packed[0] : 0))
+
+    if (length == 0 || packed[0] != CONFIG_VERSION)
+    {
+        LOG_LN("Clearing Global Config");
+        preferences.clear();
+        return false;
+    }
+
+    unpack_global_section(&global_config, packed, length);
+    unpack_global_section(&persisted_config, packed, length);
+
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++)
+    {
+        char key[12];
+        printer_section_key(i, key);
+
+        if (preferences.isKey(key))
+        {
+            preferences.getBytes(key, &global_config.printer_config[i], sizeof(PrinterConfiguration));
+            memcpy(&persisted_config.printer_config[i], &global_config.printer_config[i], sizeof(PrinterConfiguration));
+        }
+    }
+
+    return true;
+}
+
+// Older builds stored everything as a single blob. It is split into sections and only dropped once those are written
+static void migrate_legacy_config(Preferences& preferences)
+{
+    if (!preferences.isKey("global_config"))
+    {
         return;
-    
+    }
+
     GlobalConfig config = {0};
     preferences.getBytes("global_config", &config, sizeof(config));
-    LOG_F(("Config version: %d\n", config.version))
-    if (config.version != CONFIG_VERSION) {
+    LOG_F(("Config version: %d (single blob)\n", config.version))
+
+    if (config.version == CONFIG_VERSION)
+    {
+        memcpy(&global_config, &config, sizeof(GlobalConfig));
+
+        if (!flush_global_config(true))
+        {
+            // The blob stays the only complete copy. Without the global section the next boot migrates again
+            LOG_LN("Config: Moving to per-section keys failed, keeping the single blob");
+            preferences.remove("global");
+            // The next save writes every section again
+            memset(&persisted_config, 0, sizeof(GlobalConfig));
+            return;
+        }
+
+        LOG_LN("Config: Moved to per-section keys");
+    }
+    else
+    {
         LOG_LN("Clearing Global Config");
-        preferences.clear();
     }
 
-    preferences.end();
+    preferences.remove("global_config");
 }
 
 PrinterConfiguration* get_current_printer_config()
@@ -103,7 +321,6 @@ void global_config_add_new_printer()
     }
 
     global_config_set_printer(free_index);
-    ESP.restart();
 }
 
 void global_config_set_printer(int idx)
@@ -125,7 +342,6 @@ void global_config_delete_printer(int idx)
     PrinterConfiguration* config = &global_config.printer_config[idx];
     config->setup_complete = false;
     write_global_config();
-    ESP.restart();
 }
 
 void set_printer_config_index(int index)
@@ -190,11 +406,19 @@ void load_global_config()
     global_config.printer_config[0].printer_move_z_steps[1] = 10;
     global_config.printer_config[0].printer_move_z_steps[2] = 100;
 
-    verify_version();
     Preferences preferences;
-    preferences.begin("global_config", true);
-    preferences.getBytes("global_config", &global_config, sizeof(global_config));
-    preferences.end();
+
+    if (preferences.begin("global_config", false))
+    {
+        if (!read_sections(preferences))
+        {
+            migrate_legacy_config(preferences);
+        }
+
+        preferences.end();
+    }
+
+    esp_register_shutdown_handler(flush_on_shutdown);
 
     #if defined REPO_DEVELOPMENT  &&  REPO_DEVELOPMENT == 1
         temporary_config.debug = true;
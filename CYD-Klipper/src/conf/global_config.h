@@ -6,6 +6,10 @@
 #define CONFIG_VERSION 7
 #define PRINTER_CONFIG_COUNT 6
 #define DISPLAY_SECRETS 0
+// Saves are written this long after the last change, so a burst of edits costs one flash write
+#define CONFIG_WRITE_DELAY_MS 2000
+// Keeps a steady stream of edits from postponing the write forever
+#define CONFIG_WRITE_MAX_DELAY_MS 10000
 
 enum {
     REMAINING_TIME_CALC_PERCENTAGE = 0,
@@ -84,6 +88,9 @@ typedef struct {
             bool show_estop : 1;
             bool full_filenames : 1;
             bool double_size_gcode_img : 1;
+
+            // Internal, added after the fact so existing bits keep their position
+            bool wifi_static_ip_configured : 1;
         };
     };
 
@@ -100,6 +107,12 @@ typedef struct {
     unsigned char brightness;
     unsigned char screen_timeout;
     unsigned char printer_index;
+
+    // IPv4 addresses in network byte order, as IPAddress converts to and from uint32_t
+    unsigned int wifi_static_ip;
+    unsigned int wifi_static_gateway;
+    unsigned int wifi_static_subnet;
+    unsigned int wifi_static_dns;
 } GlobalConfig;
 
 // Volatile/temporary config that doesn't survive a reset
@@ -122,9 +135,13 @@ extern ColorDefinition color_defs[];
 #define LOG_LN(x) if(temporary_config.debug){ Serial.println(x);}
 #define LOG_F(x) if(temporary_config.debug){ Serial.printf x ;}   // use with double braces, LOF_F(("x=%d\n",x));
 
+// Marks the config as changed, it is written to flash by global_config_loop() once edits settle
 void write_global_config();
-void verify_version();
+// Writes pending changes right away. Not needed before ESP.restart(), that flushes by itself
+void write_global_config_now();
+void global_config_loop();
 void load_global_config();
+void global_config_print_stats();
 
 void global_config_add_new_printer();
 void global_config_set_printer(int idx);
@@ -49,14 +49,27 @@
 #define LV_MEM_CUSTOM 0
 #if LV_MEM_CUSTOM == 0
     /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
-    #define LV_MEM_SIZE (40U * 1024U)          /*[bytes]*/
+    #if defined UI_BENCHMARK_HOST
+        /*The host build has 8 byte pointers, the same screens need about twice the memory*/
+        #define LV_MEM_SIZE (96U * 1024U)          /*[bytes]*/
+    #elif defined BOARD_HAS_PSRAM
+        /*Boards with PSRAM get a larger pool outside of internal RAM, which stays free for DMA and network buffers*/
+        #define LV_MEM_SIZE (256U * 1024U)          /*[bytes]*/
+    #else
+        #define LV_MEM_SIZE (40U * 1024U)          /*[bytes]*/
+    #endif
 
     /*Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too.*/
     #define LV_MEM_ADR 0     /*0: unused*/
     /*Instead of an address give a memory allocator that will be called to get a memory pool for LVGL. E.g. my_malloc*/
     #if LV_MEM_ADR == 0
-        //#define LV_MEM_POOL_INCLUDE your_alloc_library  /* Uncomment if using an external allocator*/
-        //#define LV_MEM_POOL_ALLOC   your_alloc          /* Uncomment if using an external allocator*/
+        #ifdef BOARD_HAS_PSRAM
+            #define LV_MEM_POOL_INCLUDE <esp_heap_caps.h>
+            #define LV_MEM_POOL_ALLOC(size) heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+        #else
+            //#define LV_MEM_POOL_INCLUDE your_alloc_library  /* Uncomment if using an external allocator*/
+            //#define LV_MEM_POOL_ALLOC   your_alloc          /* Uncomment if using an external allocator*/
+        #endif
     #endif
 
 #else       /*LV_MEM_CUSTOM*/
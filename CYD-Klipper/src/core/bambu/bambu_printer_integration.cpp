@@ -1,9 +1,11 @@
 #include "bambu_printer_integration.hpp"
-#include <PubSubClient.h>
+#include "../request_metrics.h"
+#include "../host_resolver.h"
 
-WiFiClientSecure wifi_client;
-PubSubClient client(wifi_client);
-BambuPrinter* current_printer = NULL;
+// Minimum largest free block needed to open an FTPS session next to a live MQTT session
+#define BAMBU_FTPS_MIN_FREE_BLOCK 45000
+
+static BambuPrinter* live_sessions[BAMBU_MAX_LIVE_SESSIONS] = {0};
 
 const char* COMMAND_FETCH_ALL = "{\"pushing\":{\"sequence_id\":\"0\",\"command\":\"pushall\",\"version\":1,\"push_target\":1}}";
 const char* COMMAND_LIGHTCTL = "{\"system\":{\"sequence_id\":\"0\",\"command\":\"ledctrl\",\"led_node\":\"%s\",\"led_mode\":\"%s\"}}";
@@ -16,19 +18,92 @@ const char* COMMAND_FILAMENT_LOAD_EXTERNAL = "{\"print\":{\"sequence_id\":\"0\",
 const char* COMMAND_AMS_CONTOL_DONE = "{\"print\":{\"sequence_id\":\"0\",\"command\":\"ams_control\",\"param\":\"done\"}}";
 const char* COMMAND_AMS_CONTOL_RETRY = "{\"print\":{\"sequence_id\":\"0\",\"command\":\"ams_control\",\"param\":\"resume\"}}";
 
-static void callback(char* topic, byte* payload, unsigned int length)
+// PubSubClient keeps the host pointer, so a resolved address is passed by value instead
+static void set_mqtt_server(PubSubClient& client, const char* host)
+{
+    IPAddress address;
+
+    if (host_resolve(host, &address))
+    {
+        client.setServer(address, 8883);
+    }
+    else
+    {
+        client.setServer(host, 8883);
+    }
+}
+
+static int live_session_slot(BambuPrinter* printer)
+{
+    for (int i = 0; i < BAMBU_MAX_LIVE_SESSIONS; i++)
+    {
+        if (live_sessions[i] == printer)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Returns a free session slot, closing the least recently used session that does not belong to the current printer if needed
+static int reserve_session_slot()
+{
+    int free_slot = live_session_slot(NULL);
+
+    if (free_slot >= 0)
+    {
+        return free_slot;
+    }
+
+    BasePrinter* current = get_current_printer();
+    BambuPrinter* oldest = NULL;
+
+    for (int i = 0; i < BAMBU_MAX_LIVE_SESSIONS; i++)
+    {
+        if (live_sessions[i] == current)
+        {
+            continue;
+        }
+
+        if (oldest == NULL || live_sessions[i]->session_last_used < oldest->session_last_used)
+        {
+            oldest = live_sessions[i];
+        }
+    }
+
+    if (oldest == NULL)
+    {
+        return -1;
+    }
+
+    LOG_LN("Bambu: Closing least recently used session");
+    oldest->disconnect();
+    return live_session_slot(NULL);
+}
+
+void bambu_loop_sessions()
 {
-    if (current_printer != NULL)
+    for (int i = 0; i < BAMBU_MAX_LIVE_SESSIONS; i++)
     {
-        current_printer->receive_data(payload, length);
+        if (live_sessions[i] != NULL)
+        {
+            live_sessions[i]->session_loop();
+        }
     }
 }
 
 void BambuPrinter::receive_data(unsigned char* data, unsigned int length)
 {
+    RequestTiming timing;
+    request_timing_start(&timing, "bambu report");
+    request_timing_add_bytes(&timing, length);
+
     data[length] = 0;
     JsonDocument doc;
-    deserializeJson(doc, data);
+    bool parsed = deserializeJson(doc, data) == DeserializationError::Ok;
+    request_timing_mark(&timing, RequestPhaseParse);
+    request_timing_finish(&timing, parsed);
     parse_state(doc);
 }
 
@@ -114,19 +189,40 @@ bool BambuPrinter::execute_feature(PrinterFeatures feature)
     return false;
 }
 
-bool BambuPrinter::connect()
+bool BambuPrinter::open_session()
 {
+    int slot = live_session_slot(this);
+
+    if (slot < 0)
+    {
+        slot = reserve_session_slot();
+    }
+
+    if (slot < 0)
+    {
+        LOG_LN("Bambu: No session slot available");
+        return false;
+    }
+
     wifi_client.setInsecure();
     wifi_client.setTimeout(3);
-    client.setBufferSize(4096);
-    client.setServer(printer_config->printer_host, 8883);
-    current_printer = this;
+    client.setBufferSize(BAMBU_MQTT_BUFFER_SIZE);
+    set_mqtt_server(client, printer_config->printer_host);
     client.setCallback(NULL);
     char buff[10] = {0};
     sprintf(buff, "%d", printer_config->klipper_port);
-    if (!client.connect("id", "bblp", buff))
+
+    RequestTiming timing;
+    request_timing_start(&timing, "bambu connect");
+    bool connected = client.connect("id", "bblp", buff);
+    request_timing_mark(&timing, RequestPhaseConnect);
+    request_timing_finish(&timing, connected);
+
+    if (!connected)
     {
         LOG_LN("Bambu: Wrong IP or LAN code.");
+        host_resolver_invalidate(printer_config->printer_host);
+        close_session();
         return false;
     }
 
@@ -136,6 +232,7 @@ bool BambuPrinter::connect()
     if (!client.subscribe(auth))
     {
         LOG_LN("Bambu: Wrong serial number.");
+        close_session();
         return false;
     }
 
@@ -145,26 +242,67 @@ bool BambuPrinter::connect()
     if (!client.connected())
     {
         LOG_LN("Bambu: Connection lost. Likely wrong serial number.");
+        close_session();
+        return false;
+    }
+
+    client.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        receive_data(payload, length);
+    });
+
+    live_sessions[slot] = this;
+    session_last_used = millis();
+    return true;
+}
+
+void BambuPrinter::close_session()
+{
+    int slot = live_session_slot(this);
+
+    if (slot >= 0)
+    {
+        live_sessions[slot] = NULL;
+    }
+
+    client.disconnect();
+    client.setCallback(NULL);
+    client.setBufferSize(16);
+}
+
+bool BambuPrinter::session_connected()
+{
+    return live_session_slot(this) >= 0 && client.connected();
+}
+
+void BambuPrinter::session_loop()
+{
+    if (!client.loop())
+    {
+        LOG_F(("Bambu: Session of printer %d dropped\n", config_index))
+        disconnect();
+    }
+}
+
+bool BambuPrinter::connect()
+{
+    if (!open_session())
+    {
         return false;
     }
 
-    client.setCallback(callback);
     printer_data.state = PrinterState::PrinterStateIdle;
     return publish_mqtt_command(COMMAND_FETCH_ALL);
 }
 
 void BambuPrinter::disconnect()
 {
-    current_printer = NULL;
     printer_data.state = PrinterState::PrinterStateOffline;
-    client.disconnect();
-    client.setCallback(NULL);
-    client.setBufferSize(16);
+    close_session();
 }
 
 bool BambuPrinter::fetch()
 {
-    if (!client.connected())
+    if (!session_connected())
     {
         LOG_LN("Failed to fetch printer data: Not connected");
         return false;
@@ -176,16 +314,35 @@ bool BambuPrinter::fetch()
         return false;
     }
 
+    session_last_used = millis();
     return true;
 }
 
 PrinterDataMinimal BambuPrinter::fetch_min()
 {
     PrinterDataMinimal min = {};
+    min.success = false;
+
+    if (!printer_config->setup_complete)
+    {
+        min.state = PrinterStateOffline;
+        return min;
+    }
+
+    // Printers without a live session get one here; the report stream then keeps printer_data current
+    if (!session_connected() && !connect())
+    {
+        min.state = PrinterStateOffline;
+        return min;
+    }
+
+    session_loop();
+    session_last_used = millis();
+
     min.success = true;
-    min.state = PrinterState::PrinterStateIdle;
-    min.print_progress = 0;
-    min.power_devices = 0;
+    min.state = printer_data.state;
+    min.print_progress = printer_data.print_progress;
+    min.power_devices = get_power_devices_count();
     return min;
 }
 
@@ -292,8 +449,19 @@ bool BambuPrinter::set_power_device_state(const char* device_name, bool state)
 
 Files BambuPrinter::get_files()
 {
+    if (ESP.getMaxAllocHeap() >= BAMBU_FTPS_MIN_FREE_BLOCK)
+    {
+        WiFiClientSecure ftps_client;
+        ftps_client.setInsecure();
+        ftps_client.setTimeout(3);
+        return parse_files(ftps_client, 20);
+    }
+
+    // Not enough memory for a second TLS session, temporarily hand the MQTT session over to FTPS
     PrinterState state = printer_data.state;
     disconnect();
+    wifi_client.setInsecure();
+    wifi_client.setTimeout(3);
     Files files = parse_files(wifi_client, 20);
     connect();
     printer_data.state = state;
@@ -338,7 +506,7 @@ BambuConnectionStatus connection_test_bambu(PrinterConfiguration* config)
     WiFiClientSecure connection_test_wifi_client;
     PubSubClient connection_test_client(connection_test_wifi_client);
     connection_test_wifi_client.setInsecure();
-    connection_test_client.setServer(config->printer_host, 8883);
+    set_mqtt_server(connection_test_client, config->printer_host);
     char buff[10] = {0};
     sprintf(buff, "%d", config->klipper_port);
     if (!connection_test_client.connect("id", "bblp", buff))
@@ -3,6 +3,17 @@
 #include "../printer_integration.hpp"
 #include <ArduinoJson.h>
 #include <WifiClientSecure.h>
+#include <PubSubClient.h>
+
+// Every Bambu printer keeps its own MQTT session. Each session holds a TLS context and a
+// receive buffer, so only a limited amount of them are kept open at the same time.
+#define BAMBU_MQTT_BUFFER_SIZE 4096
+
+#ifdef BOARD_HAS_PSRAM
+#define BAMBU_MAX_LIVE_SESSIONS 4
+#else
+#define BAMBU_MAX_LIVE_SESSIONS 2
+#endif
 
 enum BambuSpeedProfile 
 {
@@ -18,6 +29,11 @@ class BambuPrinter : public BasePrinter
         unsigned int last_error = 0; 
         unsigned int ignore_error = 0; 
         unsigned long print_start;
+        WiFiClientSecure wifi_client;
+        PubSubClient client;
+
+        bool open_session();
+        void close_session();
 
     protected:
         void parse_state(JsonDocument& in);
@@ -28,6 +44,7 @@ class BambuPrinter : public BasePrinter
         float aux_fan_speed;
         float chamber_fan_speed;
         BambuSpeedProfile speed_profile = BambuSpeedProfileNormal;
+        unsigned long session_last_used = 0;
 
         union {
             struct {
@@ -40,7 +57,7 @@ class BambuPrinter : public BasePrinter
             unsigned char bambu_misc;
         };
 
-        BambuPrinter(int index) : BasePrinter(index)
+        BambuPrinter(int index) : BasePrinter(index), client(wifi_client)
         {
             supported_features = PrinterFeatureHome
                 | PrinterFeatureDisableSteppers
@@ -86,6 +103,8 @@ class BambuPrinter : public BasePrinter
         bool send_gcode(const char* gcode, bool wait = true);
         void receive_data(unsigned char* data, unsigned int length);
         bool publish_mqtt_command(const char* command);
+        bool session_connected();
+        void session_loop();
 };
 
 enum BambuConnectionStatus {
@@ -94,4 +113,6 @@ enum BambuConnectionStatus {
     BambuConnectSNFail = 2,
 };
 
-BambuConnectionStatus connection_test_bambu(PrinterConfiguration* config);
\ No newline at end of file
+BambuConnectionStatus connection_test_bambu(PrinterConfiguration* config);
+// Services the MQTT sessions of all connected Bambu printers, not just the current one
+void bambu_loop_sessions();
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "bambu_printer_integration.hpp"
+#include "../request_metrics.h"
+#include "../host_resolver.h"
 #include <HTTPClient.h>
 #include <list>
 
@@ -344,14 +346,18 @@ Files BambuPrinter::parse_files(WiFiClientSecure& wifi_client, int max_files)
 {
     LOG_F(("Heap space pre-file-parse: %d bytes\n", esp_get_free_heap_size()));
 
-    unsigned long timer_request = millis();
+    RequestTiming timing;
+    request_timing_start(&timing, "bambu files");
     Files result = {0};
+    String host = host_resolve_string(printer_config->printer_host);
 
-    if (!wifi_client.connect(printer_config->printer_host, 990))
+    if (!wifi_client.connect(host.c_str(), 990))
     {
         LOG_LN("Failed to fetch files: connection failed");
     }
 
+    request_timing_mark(&timing, RequestPhaseConnect);
+
     wifi_client_response_pass(wifi_client);
     
     char auth_code_buff[16] = {0};
@@ -362,12 +368,14 @@ Files BambuPrinter::parse_files(WiFiClientSecure& wifi_client, int max_files)
     send_command_without_response(wifi_client, "PASV");
     send_command_without_response(wifi_client, "NLST");
     wifi_client.stop();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
-    if (wifi_client.connect(printer_config->printer_host, 2024))
+    if (wifi_client.connect(host.c_str(), 2024))
     {
-        unsigned long timer_parse = millis();
         std::list<char*> files;
+        // The listing is parsed while it is read, so transfer includes parsing
         wifi_client_response_parse(wifi_client, files, max_files);
+        request_timing_mark(&timing, RequestPhaseTransfer);
         result.available_files = (char**)malloc(sizeof(char*) * files.size());
         if (result.available_files == NULL)
         {
@@ -377,6 +385,7 @@ Files BambuPrinter::parse_files(WiFiClientSecure& wifi_client, int max_files)
                 free(file);
             }
 
+            request_timing_finish(&timing, false);
             return result;
         }
 
@@ -386,13 +395,15 @@ Files BambuPrinter::parse_files(WiFiClientSecure& wifi_client, int max_files)
 
         result.success = true;
         LOG_F(("Heap space post-file-parse: %d bytes\n", esp_get_free_heap_size()))
-        LOG_F(("Got %d files. Request took %dms, parsing took %dms\n", files.size(), timer_parse - timer_request, millis() - timer_parse))
+        LOG_F(("Got %d files. Setup took %lums, transfer took %lums\n", files.size(),
+            (timing.phase_us[RequestPhaseConnect] + timing.phase_us[RequestPhaseFirstByte]) / 1000, timing.phase_us[RequestPhaseTransfer] / 1000))
     }   
     else 
     {
         LOG_LN("Failed to fetch files: data connection failed");
     }
 
+    request_timing_finish(&timing, result.success);
     wifi_client.stop();
     return result;
 }
\ No newline at end of file
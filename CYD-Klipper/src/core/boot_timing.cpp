@@ -0,0 +1,53 @@
+#include "boot_timing.h"
+#include "../conf/global_config.h"
+#include <HardwareSerial.h>
+#include <esp_timer.h>
+
+static const char* stage_names[BootStageCount] = {"screen ready", "first interactive frame", "wifi connecting", "wifi connected", "first printer data", "ota check done"};
+static volatile unsigned long stage_ms[BootStageCount];
+static const char* volatile stage_notes[BootStageCount];
+
+void boot_mark(BootStage stage)
+{
+    if (stage_ms[stage] != 0)
+    {
+        return;
+    }
+
+    // 0 means not reached, a stage hit in the first ms of boot still shows up
+    unsigned long now = esp_timer_get_time() / 1000;
+    stage_ms[stage] = now > 0 ? now : 1;
+    LOG_F(("Boot: %s after %lu ms\n", stage_names[stage], stage_ms[stage]))
+}
+
+void boot_note(BootStage stage, const char* note)
+{
+    if (stage_ms[stage] == 0)
+    {
+        stage_notes[stage] = note;
+    }
+}
+
+void boot_print_timings()
+{
+    for (int i = 0; i < BootStageCount; i++)
+    {
+        if (stage_ms[i] == 0)
+        {
+            Serial.printf("%-24s not reached\n", stage_names[i]);
+        }
+        else if (stage_notes[i] != NULL)
+        {
+            Serial.printf("%-24s %6lu ms (%s)\n", stage_names[i], stage_ms[i], stage_notes[i]);
+        }
+        else
+        {
+            Serial.printf("%-24s %6lu ms\n", stage_names[i], stage_ms[i]);
+        }
+    }
+
+    if (stage_ms[BootStageWifiStart] != 0 && stage_ms[BootStageWifi] != 0)
+    {
+        Serial.printf("WiFi took %lu ms to connect\n", stage_ms[BootStageWifi] - stage_ms[BootStageWifiStart]);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+ * Boot milestones, in ms since power on. Only the first time a stage is reached counts.
+ * With WiFi and the current printer configured, the UI is interactive before the network is up,
+ * so the later stages can land in any order.
+ */
+
+enum BootStage
+{
+    BootStageScreen = 0,
+    BootStageFirstFrame = 1,
+    BootStageWifiStart = 2,
+    BootStageWifi = 3,
+    BootStagePrinterData = 4,
+    BootStageOtaCheck = 5,
+    BootStageCount = 6,
+};
+
+// Safe to call from any task
+void boot_mark(BootStage stage);
+// Attaches a static string to a stage, printed next to its time. Call before marking the stage
+void boot_note(BootStage stage, const char* note);
+void boot_print_timings();
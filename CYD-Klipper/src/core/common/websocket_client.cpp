@@ -0,0 +1,300 @@
+#include "websocket_client.h"
+#include "../../conf/global_config.h"
+#include <base64.h>
+#include <esp_system.h>
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+#define WS_MAX_CONTROL_PAYLOAD 125
+
+int WebSocketClient::FrameStream::available()
+{
+    int client_available = client->available();
+    return (size_t)client_available < remaining ? client_available : (int)remaining;
+}
+
+int WebSocketClient::FrameStream::read()
+{
+    if (remaining <= 0)
+    {
+        return -1;
+    }
+
+    unsigned char c;
+    if (client->readBytes(&c, 1) != 1)
+    {
+        remaining = 0;
+        return -1;
+    }
+
+    remaining--;
+    return c;
+}
+
+int WebSocketClient::FrameStream::peek()
+{
+    if (remaining <= 0)
+    {
+        return -1;
+    }
+
+    return client->peek();
+}
+
+size_t WebSocketClient::FrameStream::readBytes(char* buffer, size_t length)
+{
+    if (length > remaining)
+    {
+        length = remaining;
+    }
+
+    size_t read = client->readBytes(buffer, length);
+    remaining = read == length ? remaining - read : 0;
+    return read;
+}
+
+bool WebSocketClient::read_exact(unsigned char* buffer, size_t length)
+{
+    return client.readBytes(buffer, length) == length;
+}
+
+bool WebSocketClient::send_frame(unsigned char opcode, const unsigned char* payload, size_t length)
+{
+    unsigned char header[14];
+    size_t header_length = 2;
+
+    header[0] = 0x80 | opcode;
+
+    if (length < 126)
+    {
+        header[1] = 0x80 | length;
+    }
+    else if (length <= 0xFFFF)
+    {
+        header[1] = 0x80 | 126;
+        header[2] = length >> 8;
+        header[3] = length & 0xFF;
+        header_length = 4;
+    }
+    else
+    {
+        return false;
+    }
+
+    // Client to server frames must always be masked
+    uint32_t mask_key = esp_random();
+    unsigned char* mask = header + header_length;
+    memcpy(mask, &mask_key, 4);
+    header_length += 4;
+
+    if (client.write(header, header_length) != header_length)
+    {
+        return false;
+    }
+
+    unsigned char chunk[64];
+    for (size_t offset = 0; offset < length; offset += sizeof(chunk))
+    {
+        size_t chunk_length = length - offset < sizeof(chunk) ? length - offset : sizeof(chunk);
+
+        for (size_t i = 0; i < chunk_length; i++)
+        {
+            chunk[i] = payload[offset + i] ^ mask[(offset + i) % 4];
+        }
+
+        if (client.write(chunk, chunk_length) != chunk_length)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WebSocketClient::connect(const char* host, unsigned short port, const char* path, const char* extra_headers, int timeout_ms)
+{
+    disconnect();
+    client.setTimeout((timeout_ms + 999) / 1000);
+
+    if (!client.connect(host, port, timeout_ms))
+    {
+        LOG_F(("WebSocket: Failed to connect to %s:%d\n", host, port))
+        return false;
+    }
+
+    unsigned char key[16];
+    esp_fill_random(key, sizeof(key));
+
+    client.printf("GET %s HTTP/1.1\r\nHost: %s:%d\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n",
+        path, host, port, base64::encode(key, sizeof(key)).c_str());
+
+    if (extra_headers != NULL)
+    {
+        client.print(extra_headers);
+    }
+
+    client.print("\r\n");
+
+    String status = client.readStringUntil('\n');
+    if (!status.startsWith("HTTP/1.1 101"))
+    {
+        LOG_F(("WebSocket: Upgrade refused: %s\n", status.c_str()))
+        client.stop();
+        return false;
+    }
+
+    while (true)
+    {
+        String line = client.readStringUntil('\n');
+
+        if (line.length() <= 0 && !client.connected())
+        {
+            client.stop();
+            return false;
+        }
+
+        if (line == "\r" || line.length() <= 0)
+        {
+            break;
+        }
+    }
+
+    stream.client = &client;
+    stream.remaining = 0;
+    return true;
+}
+
+void WebSocketClient::disconnect()
+{
+    if (client.connected())
+    {
+        send_frame(WS_OPCODE_CLOSE, NULL, 0);
+    }
+
+    client.stop();
+    stream.remaining = 0;
+}
+
+bool WebSocketClient::connected()
+{
+    return client.connected();
+}
+
+bool WebSocketClient::send_text(const char* text)
+{
+    return send_frame(WS_OPCODE_TEXT, (const unsigned char*)text, strlen(text));
+}
+
+size_t WebSocketClient::poll_text_frame()
+{
+    skip_frame();
+
+    while (client.available() >= 2)
+    {
+        unsigned char header[2];
+        if (!read_exact(header, 2))
+        {
+            client.stop();
+            return 0;
+        }
+
+        bool fin = header[0] & 0x80;
+        unsigned char opcode = header[0] & 0x0F;
+        bool masked = header[1] & 0x80;
+        uint64_t length = header[1] & 0x7F;
+
+        if (length == 126)
+        {
+            unsigned char ext[2];
+            if (!read_exact(ext, 2))
+            {
+                client.stop();
+                return 0;
+            }
+
+            length = (ext[0] << 8) | ext[1];
+        }
+        else if (length == 127)
+        {
+            unsigned char ext[8];
+            if (!read_exact(ext, 8))
+            {
+                client.stop();
+                return 0;
+            }
+
+            length = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                length = (length << 8) | ext[i];
+            }
+        }
+
+        // Servers never mask their frames
+        if (masked)
+        {
+            LOG_LN("WebSocket: Received masked frame, closing");
+            client.stop();
+            return 0;
+        }
+
+        stream.remaining = length;
+
+        if (opcode == WS_OPCODE_TEXT && fin && length > 0)
+        {
+            return length;
+        }
+
+        if (opcode == WS_OPCODE_PING && length <= WS_MAX_CONTROL_PAYLOAD)
+        {
+            unsigned char payload[WS_MAX_CONTROL_PAYLOAD];
+            stream.readBytes((char*)payload, length);
+            send_frame(WS_OPCODE_PONG, payload, length);
+            continue;
+        }
+
+        if (opcode == WS_OPCODE_CLOSE)
+        {
+            LOG_LN("WebSocket: Closed by server");
+            client.stop();
+            stream.remaining = 0;
+            return 0;
+        }
+
+        if (opcode != WS_OPCODE_PONG)
+        {
+            LOG_F(("WebSocket: Skipping frame (opcode %d, fin %d, %d bytes)\n", opcode, fin, (int)length))
+        }
+
+        skip_frame();
+    }
+
+    return 0;
+}
+
+Stream& WebSocketClient::frame_stream()
+{
+    return stream;
+}
+
+void WebSocketClient::skip_frame()
+{
+    char discard[64];
+
+    while (stream.remaining > 0)
+    {
+        size_t chunk_length = stream.remaining < sizeof(discard) ? stream.remaining : sizeof(discard);
+
+        if (stream.readBytes(discard, chunk_length) != chunk_length)
+        {
+            client.stop();
+            stream.remaining = 0;
+            return;
+        }
+    }
+}
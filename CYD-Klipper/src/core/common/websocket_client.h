@@ -0,0 +1,41 @@
+#pragma once
+
+#include <WiFiClient.h>
+
+// Minimal RFC 6455 client for plain ws:// endpoints. Text frames are read in place
+// through frame_stream(), so payloads can be deserialized without a buffer copy.
+// Fragmented messages are not supported and are skipped.
+class WebSocketClient
+{
+    private:
+        class FrameStream : public Stream
+        {
+            public:
+                WiFiClient* client = NULL;
+                size_t remaining = 0;
+
+                int available() override;
+                int read() override;
+                int peek() override;
+                size_t readBytes(char* buffer, size_t length);
+                size_t write(uint8_t) override { return 0; }
+                void flush() override {}
+        };
+
+        WiFiClient client;
+        FrameStream stream;
+
+        bool read_exact(unsigned char* buffer, size_t length);
+        bool send_frame(unsigned char opcode, const unsigned char* payload, size_t length);
+
+    public:
+        bool connect(const char* host, unsigned short port, const char* path, const char* extra_headers = NULL, int timeout_ms = 1000);
+        void disconnect();
+        bool connected();
+        bool send_text(const char* text);
+        // Handles control frames and returns the payload length of the next text frame, or 0 when none is pending.
+        // The payload must be consumed through frame_stream() or dropped with skip_frame() before polling again.
+        size_t poll_text_frame();
+        Stream& frame_stream();
+        void skip_frame();
+};
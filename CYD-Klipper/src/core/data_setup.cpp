@@ -1,6 +1,7 @@
 
 #include "data_setup.h"
 #include "semaphore.h"
+#include "task_layout.h"
 #include <esp_task_wdt.h>
 #include <UrlEncode.h>
 #include "printer_integration.hpp"
@@ -8,78 +9,242 @@
 #include "klipper-serial/serial_klipper_printer_integration.hpp"
 #include "bambu/bambu_printer_integration.hpp"
 #include "octoprint/octoprint_printer_integration.hpp"
+#include "lv_setup.h"
+#include <WiFi.h>
 
 const long data_update_interval = 780;
+// Polling slows down to this heartbeat while the screen sleeps
+const long data_update_interval_asleep = 5000;
 
-void fetch_printer_data()
+// Upper bound on how long the LVGL loop sleeps waiting for printer updates, keeps the serial console responsive
+#define DATA_LOOP_MAX_IDLE_MS 10
+// Printers that are not shown share one request per slot, so the request rate stays the same however many printers there are
+#define DATA_FLEET_SLOT_MS 750
+// Every this many visits of a printer its slot goes to counting power devices instead
+#define DATA_FLEET_POWER_DEVICES_EVERY 8
+// Offline printers are reconnected at most this often, connecting to a printer that is off takes until the timeout
+#define DATA_FLEET_RECONNECT_INTERVAL_MS 30000
+
+// Expects the requests of the printer to be frozen. Returns false when there is nothing to announce
+static bool fetch_frozen_printer_data(int index)
 {
-    freeze_request_thread();
+    BasePrinter* printer = get_printer(index);
 
-    if (get_current_printer_data()->state == PrinterStateOffline)
+    if (get_printer_data(index)->state == PrinterStateOffline)
     {
-        if (!get_current_printer()->connect())
+        if (!printer->connect())
         {
-            LOG_LN("Failed to connect to printer");
-            unfreeze_request_thread();
-            return;
+            LOG_F(("Failed to connect to printer %d\n", index))
+            return false;
         }
     }
 
-    bool fetch_result = get_current_printer()->fetch();
-    unfreeze_request_thread();
+    bool fetch_result = printer->fetch();
 
-    freeze_render_thread();
+    // The UI no longer waits for this thread, so the printer must not be torn down under its requests
     if (!fetch_result)
     {
-        LOG_LN("Failed to fetch printer data")
-        get_current_printer()->disconnect();
+        LOG_F(("Failed to fetch data of printer %d\n", index))
+        printer->disconnect();
     }
 
-    get_current_printer()->AnnouncePrinterData();
-    unfreeze_render_thread();
+    return true;
 }
 
-void fetch_printer_data_minimal()
+void fetch_printer_data()
 {
-    PrinterDataMinimal data[PRINTER_CONFIG_COUNT] = {{}};
-    for (int i = 0; i < get_printer_count(); i++)
+    int index = get_current_printer_index();
+    BasePrinter* printer = freeze_request_thread();
+
+    // Another printer was shown while waiting for the lock, data_poll_now brings the next cycle forward
+    if (printer != get_printer(index))
     {
-        freeze_request_thread();
-        BasePrinter* printer = get_printer(i);
         unfreeze_request_thread();
-        data[i] = printer->fetch_min();
+        return;
+    }
+
+    bool fetched = fetch_frozen_printer_data(index);
+    unfreeze_request_thread();
+
+    if (fetched)
+    {
+        printer->AnnouncePrinterData();
+    }
+}
+
+// Only takes the lock of the printer itself, its connect timeout and TLS handshake do not hold up the UI
+static void fetch_background_printer_data(int index)
+{
+    BasePrinter* printer = get_printer(index);
+    freeze_printer_requests(printer);
+    bool fetched = fetch_frozen_printer_data(index);
+    unfreeze_printer_requests(printer);
+
+    if (fetched)
+    {
+        printer->AnnouncePrinterData();
     }
-    freeze_render_thread();
-    announce_printer_data_minimal(data);
-    unfreeze_render_thread();
 }
 
-void data_loop()
+static unsigned long fleet_slot_at;
+static unsigned long fleet_connected_at[PRINTER_CONFIG_COUNT];
+static unsigned char fleet_visits[PRINTER_CONFIG_COUNT];
+static unsigned char fleet_next = 0;
+
+static void fetch_power_devices_of(int index)
 {
-    // Causes other threads that are trying to lock the thread to actually lock it
-    unfreeze_render_thread();
-    delay(1);
-    freeze_render_thread();
+    // Runs next to the network task, which may be using the same printer connection
+    BasePrinter* printer = get_printer(index);
+    freeze_printer_requests(printer);
+    int count = printer->get_power_devices_count();
+    unfreeze_printer_requests(printer);
+    announce_printer_power_devices(index, max(count, 0));
+}
+
+// Spends at most one request per slot on the next printer in turn. The shown printer is polled by the network task,
+// its visits only count power devices
+static void fetch_fleet_printer_data()
+{
+    unsigned int count = get_printer_count();
+    unsigned long now = millis();
+
+    if (count == 0 || now - fleet_slot_at < DATA_FLEET_SLOT_MS)
+    {
+        return;
+    }
+
+    // The printers may have been recreated with fewer of them
+    if (fleet_next >= count)
+    {
+        fleet_next = 0;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        int index = fleet_next;
+        fleet_next = (fleet_next + 1) % count;
+
+        if (fleet_visits[index]++ % DATA_FLEET_POWER_DEVICES_EVERY == 0)
+        {
+            fleet_slot_at = now;
+            fetch_power_devices_of(index);
+            return;
+        }
+
+        if (index == get_current_printer_index())
+        {
+            continue;
+        }
+
+        if (get_printer_data(index)->state == PrinterStateOffline)
+        {
+            if (fleet_connected_at[index] != 0 && now - fleet_connected_at[index] < DATA_FLEET_RECONNECT_INTERVAL_MS)
+            {
+                continue;
+            }
+
+            fleet_connected_at[index] = now;
+        }
+
+        fleet_slot_at = now;
+        fetch_background_printer_data(index);
+        return;
+    }
+}
+
+void data_loop(unsigned int idle_ms)
+{
+    if (idle_ms > DATA_LOOP_MAX_IDLE_MS)
+    {
+        idle_ms = DATA_LOOP_MAX_IDLE_MS;
+    }
+
+    wait_for_printer_updates(idle_ms);
+
+    unsigned long start = micros();
+    apply_printer_updates();
+    task_add_busy_time(TaskIdRender, micros() - start);
+}
+
+TaskHandle_t background_loop;
+TaskHandle_t prefetch_loop;
+
+// Held by a polling task for a whole cycle, up to handing the result to the LVGL loop. Taking both pauses polling
+static SemaphoreHandle_t background_cycle_lock;
+static SemaphoreHandle_t prefetch_cycle_lock;
+
+// During a staged boot the polling tasks start before WiFi is associated
+static bool network_up()
+{
+    return !global_config.wifi_configured || WiFi.status() == WL_CONNECTED;
+}
+
+// A wake-up through data_poll_now ends the wait early
+static void wait_for_next_poll()
+{
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(is_screen_asleep() ? data_update_interval_asleep : data_update_interval));
+}
+
+void data_poll_now()
+{
+    if (background_loop != NULL)
+    {
+        xTaskNotifyGive(background_loop);
+    }
+
+    if (prefetch_loop != NULL)
+    {
+        xTaskNotifyGive(prefetch_loop);
+    }
 }
 
 void data_loop_background(void * param){
     esp_task_wdt_init(10, true);
-    int loop_iter = 20;
+    task_register(TaskIdNetwork);
+
+    // The first fetch happens as soon as the network is up, the UI is already showing the connecting panel
     while (true){
-        delay(data_update_interval);
-        fetch_printer_data();
-        if (global_config.multi_printer_mode) {
-            if (loop_iter++ > 20){
-                fetch_printer_data_minimal();
-                loop_iter = 0;
-            }
+        xSemaphoreTake(background_cycle_lock, portMAX_DELAY);
+
+        if (network_up()){
+            unsigned long start = micros();
+            fetch_printer_data();
+            task_add_busy_time(TaskIdNetwork, micros() - start);
         }
+
+        xSemaphoreGive(background_cycle_lock);
+        wait_for_next_poll();
     }
 }
 
-TaskHandle_t background_loop;
+void data_loop_prefetch(void * param){
+    task_register(TaskIdPrefetch);
 
-void data_setup()
+    while (true){
+        wait_for_next_poll();
+
+        if (!network_up()){
+            continue;
+        }
+
+        xSemaphoreTake(prefetch_cycle_lock, portMAX_DELAY);
+        unsigned long start = micros();
+
+        // Keeps the MQTT sessions of background Bambu printers alive
+        freeze_request_thread();
+        bambu_loop_sessions();
+        unfreeze_request_thread();
+
+        if (global_config.multi_printer_mode) {
+            fetch_fleet_printer_data();
+        }
+
+        task_add_busy_time(TaskIdPrefetch, micros() - start);
+        xSemaphoreGive(prefetch_cycle_lock);
+    }
+}
+
+static void create_printers()
 {
     BasePrinter** available_printers = (BasePrinter**)malloc(sizeof(BasePrinter*) * PRINTER_CONFIG_COUNT);
     int count = 0;
@@ -114,8 +279,43 @@ void data_setup()
     initialize_printers(available_printers, count);
     set_current_printer(true_current_printer_index);
     LOG_F(("Free heap after printer creation: %d bytes\n", esp_get_free_heap_size()));
-    semaphore_init();
-    fetch_printer_data();
-    freeze_render_thread();
-    xTaskCreatePinnedToCore(data_loop_background, "data_loop_background", 5000, NULL, 2, &background_loop, 0);
 }
+
+// The polling tasks may be blocked on a full update queue, so it keeps being emptied while waiting for them
+static void take_cycle_lock(SemaphoreHandle_t lock)
+{
+    while (xSemaphoreTake(lock, pdMS_TO_TICKS(DATA_LOOP_MAX_IDLE_MS)) != pdTRUE)
+    {
+        apply_printer_updates();
+    }
+}
+
+void data_pause()
+{
+    take_cycle_lock(background_cycle_lock);
+    take_cycle_lock(prefetch_cycle_lock);
+    apply_printer_updates();
+}
+
+void data_resume()
+{
+    xSemaphoreGive(prefetch_cycle_lock);
+    xSemaphoreGive(background_cycle_lock);
+    data_poll_now();
+}
+
+void data_recreate_printers()
+{
+    release_printers();
+    create_printers();
+}
+
+void data_setup()
+{
+    create_printers();
+    semaphore_init();
+    background_cycle_lock = xSemaphoreCreateMutex();
+    prefetch_cycle_lock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(data_loop_background, "data_loop_background", TASK_NETWORK_STACK, NULL, TASK_NETWORK_PRIORITY, &background_loop, TASK_NETWORK_CORE);
+    xTaskCreatePinnedToCore(data_loop_prefetch, "data_loop_prefetch", TASK_PREFETCH_STACK, NULL, TASK_PREFETCH_PRIORITY, &prefetch_loop, TASK_PREFETCH_CORE);
+}
\ No newline at end of file
@@ -1,4 +1,13 @@
 #pragma once
 
-void data_loop();
-void data_setup();
\ No newline at end of file
+// Applies queued printer updates, waiting up to idle_ms for the first one
+void data_loop(unsigned int idle_ms);
+void data_setup();
+// Ends the current wait of the polling tasks, so they fetch right away
+void data_poll_now();
+// Waits for the polling tasks to finish their current cycle and keeps them from starting another one.
+// Their updates are applied meanwhile, call from the LVGL loop only
+void data_pause();
+void data_resume();
+// Deletes the printers and creates them again from global_config, only while paused
+void data_recreate_printers();
\ No newline at end of file
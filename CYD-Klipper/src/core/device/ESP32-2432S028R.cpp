@@ -24,8 +24,12 @@
 SPIClass touchscreen_spi = SPIClass(HSPI);
 XPT2046_Touchscreen touchscreen(XPT2046_CS, XPT2046_IRQ);
 
+// Two half-size buffers use the same memory as the previous single buffer, but let LVGL render during DMA transfers
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 20)
+
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10];
+static lv_color_t buf_1[DRAW_BUFFER_PX];
+static lv_color_t buf_2[DRAW_BUFFER_PX];
 
 TFT_eSPI tft = TFT_eSPI();
 
@@ -43,11 +47,10 @@ void screen_lv_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *col
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
+    // The bus stays claimed between flushes. pushImageDMA waits for the previous transfer to finish
+    // before starting this one, so LVGL can render into the other buffer as soon as we return.
     tft.startWrite();
-    tft.setAddrWindow(area->x1, area->y1, w, h);
-    tft.pushColors((uint16_t *)&color_p->full, w * h, true);
-    tft.endWrite();
-
+    tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
     lv_disp_flush_ready(disp);
 }
 
@@ -67,9 +70,17 @@ void screen_lv_touchRead(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 }
 
 void set_invert_display(){
+    tft.dmaWait();
     tft.invertDisplay(global_config.printer_config[global_config.printer_index].invert_colors);
 }
 
+void screen_apply_rotation(){
+    tft.dmaWait();
+    tft.setRotation(global_config.rotate_screen ? 3 : 1);
+    touchscreen.setRotation(global_config.rotate_screen ? 3 : 1);
+    lv_obj_invalidate(lv_scr_act());
+}
+
 void screen_setup()
 {
     touchscreen_spi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
@@ -79,6 +90,8 @@ void screen_setup()
     lv_init();
 
     tft.init();
+    tft.initDMA();
+    tft.setSwapBytes(true);
 
     if (global_config.display_mode) {
         // <3 https://github.com/witnessmenow/ESP32-Cheap-Yellow-Display/blob/main/cyd.md#the-display-doesnt-look-as-good
@@ -98,7 +111,7 @@ void screen_setup()
     touchscreen_spi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
     touchscreen.begin(touchscreen_spi);
 
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10);
+    lv_disp_draw_buf_init(&draw_buf, buf_1, buf_2, DRAW_BUFFER_PX);
 
     /*Initialize the display*/
     static lv_disp_drv_t disp_drv;
@@ -20,8 +20,12 @@
 
 TAMC_GT911 tp = TAMC_GT911(TOUCH_SDA, TOUCH_SCL, TOUCH_INT, TOUCH_RST, TOUCH_WIDTH, TOUCH_HEIGHT);
 
+// Two half-size buffers use the same memory as the previous single buffer, but let LVGL render during DMA transfers
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 20)
+
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10];
+static lv_color_t buf_1[DRAW_BUFFER_PX];
+static lv_color_t buf_2[DRAW_BUFFER_PX];
 
 TFT_eSPI tft = TFT_eSPI();
 
@@ -39,11 +43,10 @@ void screen_lv_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *col
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
+    // The bus stays claimed between flushes. pushImageDMA waits for the previous transfer to finish
+    // before starting this one, so LVGL can render into the other buffer as soon as we return.
     tft.startWrite();
-    tft.setAddrWindow(area->x1, area->y1, w, h);
-    tft.pushColors((uint16_t *)&color_p->full, w * h, true);
-    tft.endWrite();
-
+    tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
     lv_disp_flush_ready(disp);
 }
 
@@ -86,9 +89,22 @@ void screen_lv_touchRead(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 
 void set_invert_display()
 {
+    tft.dmaWait();
     tft.invertDisplay(global_config.printer_config[global_config.printer_index].invert_colors);
 }
 
+void screen_apply_rotation()
+{
+    // Touch points are rotated on every read
+    tft.dmaWait();
+    #ifdef CYD_SCREEN_VERTICAL
+        tft.setRotation(global_config.rotate_screen ? 2 : 0);
+    #else
+        tft.setRotation(global_config.rotate_screen ? 3 : 1);
+    #endif
+    lv_obj_invalidate(lv_scr_act());
+}
+
 void set_LED_color(uint8_t rgbVal[3])
 {
     analogWrite(LED_PIN_R, 255 - rgbVal[0]);
@@ -114,13 +130,15 @@ void screen_setup()
     lv_init();
     // Initialize the display
     tft.init();
+    tft.initDMA();
+    tft.setSwapBytes(true);
     ledcSetup(0, 5000, 12);
     ledcAttachPin(TFT_BL, 0);
     tft.fillScreen(TFT_BLACK);
     set_invert_display();
     LED_init();
 
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, TFT_WIDTH * TFT_HEIGHT / 10);
+    lv_disp_draw_buf_init(&draw_buf, buf_1, buf_2, DRAW_BUFFER_PX);
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
 
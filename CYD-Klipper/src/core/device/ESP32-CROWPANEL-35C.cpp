@@ -7,13 +7,22 @@
 #include <LovyanGFX.hpp>
 #include <Arduino.h>
 #include <Wire.h>
+#include <esp_heap_caps.h>
 
 #ifdef CYD_SCREEN_VERTICAL
 #error "Vertical screen not supported with the ESP32_CROWPANEL_28R driver"
 #endif
 
+#ifdef BOARD_HAS_PSRAM
+// A half frame buffer in PSRAM renders most screens in two flushes and keeps internal RAM free
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 2)
+#define DRAW_BUFFER_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10)
+#define DRAW_BUFFER_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10];
 
 #define BUZZER_PIN 20
 #define LCD_BL 46
@@ -110,6 +119,12 @@ void set_invert_display()
     // TODO
 }
 
+void screen_apply_rotation()
+{
+    tft.setRotation(global_config.rotate_screen ? 3 : 1);
+    lv_obj_invalidate(lv_scr_act());
+}
+
 void screen_lv_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
     uint32_t w = (area->x2 - area->x1 + 1);
@@ -161,7 +176,19 @@ void screen_setup()
 */
 
     lv_init();
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, CYD_SCREEN_WIDTH_PX * CYD_SCREEN_HEIGHT_PX / 10);
+
+    lv_color_t * buf = (lv_color_t *)heap_caps_malloc(DRAW_BUFFER_PX * sizeof(lv_color_t), DRAW_BUFFER_CAPS);
+
+    if (buf == NULL)
+    {
+        LOG_LN("Failed to allocate draw buffer, falling back to a small one in internal RAM");
+        buf = (lv_color_t *)heap_caps_malloc(CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10 * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        lv_disp_draw_buf_init(&draw_buf, buf, NULL, CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10);
+    }
+    else
+    {
+        lv_disp_draw_buf_init(&draw_buf, buf, NULL, DRAW_BUFFER_PX);
+    }
 
     /*Initialize the display*/
     static lv_disp_drv_t disp_drv;
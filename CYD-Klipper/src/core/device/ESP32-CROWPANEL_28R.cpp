@@ -14,8 +14,12 @@
 
 #define TOUCH_THRESHOLD 600
 
+// Two half-size buffers use the same memory as the previous single buffer, but let LVGL render during DMA transfers
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 20)
+
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10];
+static lv_color_t buf_1[DRAW_BUFFER_PX];
+static lv_color_t buf_2[DRAW_BUFFER_PX];
 
 TFT_eSPI tft = TFT_eSPI();
 
@@ -35,16 +39,18 @@ void screen_lv_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *col
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
+    // The bus stays claimed between flushes. pushImageDMA waits for the previous transfer to finish
+    // before starting this one, so LVGL can render into the other buffer as soon as we return.
     tft.startWrite();
-    tft.setAddrWindow(area->x1, area->y1, w, h);
-    tft.pushColors((uint16_t *)&color_p->full, w * h, true);
-    tft.endWrite();
-
+    tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
     lv_disp_flush_ready(disp);
 }
 
 void screen_lv_touchRead(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 {
+    // Touch shares the display bus, wait for the running transfer and release the bus first
+    tft.endWrite();
+
     if (tft.getTouch( &touchX, &touchY, TOUCH_THRESHOLD))
     {
         data->state = LV_INDEV_STATE_PR;
@@ -58,9 +64,14 @@ void screen_lv_touchRead(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 }
 
 void set_invert_display(){
+    tft.dmaWait();
     tft.invertDisplay(global_config.printer_config[global_config.printer_index].invert_colors);
 }
 
+void screen_apply_rotation(){
+    // Rotation is not supported on this panel
+}
+
 void screen_setup()
 {
     uint16_t calData[5] = { 189, 3416, 359, 3439, 1};
@@ -68,6 +79,8 @@ void screen_setup()
     lv_init();
 
     tft.init();
+    tft.initDMA();
+    tft.setSwapBytes(true);
     tft.fillScreen(TFT_BLACK);
     tft.invertDisplay(false);
     delay(300);
@@ -78,7 +91,7 @@ void screen_setup()
     ledcSetup(0, 5000, 12);
     ledcAttachPin(TFT_BL, 0);
 
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 10);
+    lv_disp_draw_buf_init(&draw_buf, buf_1, buf_2, DRAW_BUFFER_PX);
 
     /*Initialize the display*/
     static lv_disp_drv_t disp_drv;
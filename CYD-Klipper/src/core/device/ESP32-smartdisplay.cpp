@@ -19,6 +19,11 @@ void set_invert_display()
     lv_obj_invalidate(lv_scr_act());
 }
 
+void screen_apply_rotation()
+{
+    lv_disp_set_rotation(lv_disp_get_default(), (global_config.rotate_screen) ? ROTATION_INVERTED : ROTATION_NORMAL);
+}
+
 void lv_screen_intercept(_lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
 {
     if (global_config.printer_config[global_config.printer_index].invert_colors) {
@@ -0,0 +1,69 @@
+#ifdef CYD_SCREEN_DRIVER_FRAMEBUFFER
+#include "../screen_driver.h"
+
+// Renders into memory instead of a panel, for the host build. There is no touch input
+
+#include "../../conf/global_config.h"
+#include "lvgl.h"
+
+// Same buffers as the ESP32_2432S028R driver, so LVGL splits redraws the same way
+#define DRAW_BUFFER_PX (CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX / 20)
+
+static lv_disp_draw_buf_t draw_buf;
+static lv_color_t buf_1[DRAW_BUFFER_PX];
+static lv_color_t buf_2[DRAW_BUFFER_PX];
+static lv_color_t framebuffer[CYD_SCREEN_HEIGHT_PX * CYD_SCREEN_WIDTH_PX];
+
+void screen_setBrightness(unsigned char brightness)
+{
+}
+
+void screen_lv_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+{
+    uint32_t w = (area->x2 - area->x1 + 1);
+
+    for (lv_coord_t y = area->y1; y <= area->y2; y++)
+    {
+        memcpy(&framebuffer[y * CYD_SCREEN_WIDTH_PX + area->x1], color_p, w * sizeof(lv_color_t));
+        color_p += w;
+    }
+
+    lv_disp_flush_ready(disp);
+}
+
+void screen_lv_touchRead(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+{
+    data->state = LV_INDEV_STATE_REL;
+}
+
+void set_invert_display()
+{
+}
+
+void screen_apply_rotation()
+{
+    lv_obj_invalidate(lv_scr_act());
+}
+
+void screen_setup()
+{
+    lv_init();
+
+    lv_disp_draw_buf_init(&draw_buf, buf_1, buf_2, DRAW_BUFFER_PX);
+
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = CYD_SCREEN_WIDTH_PX;
+    disp_drv.ver_res = CYD_SCREEN_HEIGHT_PX;
+    disp_drv.flush_cb = screen_lv_flush;
+    disp_drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&disp_drv);
+
+    static lv_indev_drv_t indev_drv;
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = screen_lv_touchRead;
+    lv_indev_drv_register(&indev_drv);
+}
+
+#endif // CYD_SCREEN_DRIVER_FRAMEBUFFER
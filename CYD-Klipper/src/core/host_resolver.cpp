@@ -0,0 +1,222 @@
+#include "host_resolver.h"
+#include "../conf/global_config.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+#include <strings.h>
+
+typedef struct
+{
+    char host[65];
+    // 0 while no lookup succeeded yet
+    uint32_t address;
+    unsigned long resolved_at;
+    unsigned long retry_at;
+    unsigned long backoff_ms;
+    unsigned long used_at;
+    unsigned int lookups;
+    unsigned int failures;
+} HostEntry;
+
+// Lookups come from the network, prefetch and render tasks
+static portMUX_TYPE resolver_lock = portMUX_INITIALIZER_UNLOCKED;
+static HostEntry entries[HOST_RESOLVER_ENTRIES];
+static bool mdns_started = false;
+
+void host_resolver_init()
+{
+    if (mdns_started || global_config.wifi_configuration_skipped)
+    {
+        return;
+    }
+
+    mdns_started = MDNS.begin("cyd-klipper");
+    LOG_F(("mDNS responder %s\n", mdns_started ? "started" : "failed to start"))
+}
+
+static bool is_mdns_name(const char* host)
+{
+    size_t length = strlen(host);
+    return length > 6 && strcasecmp(host + length - 6, ".local") == 0;
+}
+
+// Must be called with the lock held. When full, the least recently used entry is replaced
+static HostEntry* find_entry(const char* host, unsigned long now)
+{
+    HostEntry* oldest = &entries[0];
+
+    for (int i = 0; i < HOST_RESOLVER_ENTRIES; i++)
+    {
+        HostEntry* entry = &entries[i];
+
+        if (strcmp(entry->host, host) == 0)
+        {
+            return entry;
+        }
+
+        if (entry->host[0] == '\0' || (oldest->host[0] != '\0' && (long)(entry->used_at - oldest->used_at) < 0))
+        {
+            oldest = entry;
+        }
+    }
+
+    memset(oldest, 0, sizeof(HostEntry));
+    strncpy(oldest->host, host, sizeof(oldest->host) - 1);
+    oldest->retry_at = now;
+    oldest->used_at = now;
+    return oldest;
+}
+
+static bool lookup(const char* host, IPAddress* address)
+{
+    if (is_mdns_name(host))
+    {
+        if (!mdns_started)
+        {
+            return false;
+        }
+
+        char name[65] = {0};
+        strncpy(name, host, strlen(host) - 6);
+        *address = MDNS.queryHost(name, HOST_RESOLVER_MDNS_TIMEOUT_MS);
+        return (uint32_t)*address != 0;
+    }
+
+    return WiFi.hostByName(host, *address) == 1;
+}
+
+bool host_resolve(const char* host, IPAddress* address)
+{
+    if (address->fromString(host))
+    {
+        return true;
+    }
+
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&resolver_lock);
+    HostEntry* entry = find_entry(host, now);
+    entry->used_at = now;
+    uint32_t cached = entry->address;
+    bool due = (long)(now - entry->retry_at) >= 0;
+
+    // Pushed ahead before looking up, so other tasks keep using the cached address meanwhile
+    if (due)
+    {
+        entry->retry_at = now + HOST_RESOLVER_MDNS_TIMEOUT_MS;
+    }
+
+    portEXIT_CRITICAL(&resolver_lock);
+
+    if (!due)
+    {
+        *address = IPAddress(cached);
+        return cached != 0;
+    }
+
+    IPAddress resolved;
+    bool success = lookup(host, &resolved);
+    unsigned long done = millis();
+
+    portENTER_CRITICAL(&resolver_lock);
+    entry = find_entry(host, done);
+    entry->lookups++;
+
+    if (success)
+    {
+        entry->address = resolved;
+        entry->resolved_at = done;
+        entry->retry_at = done + HOST_RESOLVER_TTL_MS;
+        entry->backoff_ms = 0;
+    }
+    else
+    {
+        entry->failures++;
+        entry->backoff_ms = entry->backoff_ms == 0 ? HOST_RESOLVER_BACKOFF_MIN_MS : min(entry->backoff_ms * 2, (unsigned long)HOST_RESOLVER_BACKOFF_MAX_MS);
+        entry->retry_at = done + entry->backoff_ms;
+    }
+
+    cached = entry->address;
+    portEXIT_CRITICAL(&resolver_lock);
+
+    LOG_F(("Resolved %s to %s in %lu ms\n", host, success ? resolved.toString().c_str() : "nothing", done - now))
+    *address = IPAddress(cached);
+    return cached != 0;
+}
+
+String host_resolve_string(const char* host)
+{
+    IPAddress address;
+
+    if (host_resolve(host, &address))
+    {
+        return address.toString();
+    }
+
+    return String(host);
+}
+
+void host_resolver_invalidate(const char* host)
+{
+    unsigned long now = millis();
+    portENTER_CRITICAL(&resolver_lock);
+
+    for (int i = 0; i < HOST_RESOLVER_ENTRIES; i++)
+    {
+        HostEntry* entry = &entries[i];
+
+        // A printer that is down would otherwise cause a lookup on every poll
+        if (strcmp(entry->host, host) == 0 && entry->backoff_ms == 0 && now - entry->resolved_at >= HOST_RESOLVER_MIN_AGE_MS)
+        {
+            entry->retry_at = now;
+        }
+    }
+
+    portEXIT_CRITICAL(&resolver_lock);
+}
+
+void host_resolver_seed(const char* host, IPAddress address)
+{
+    IPAddress parsed;
+
+    if (parsed.fromString(host))
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+    portENTER_CRITICAL(&resolver_lock);
+    HostEntry* entry = find_entry(host, now);
+    entry->address = address;
+    entry->resolved_at = now;
+    entry->retry_at = now + HOST_RESOLVER_TTL_MS;
+    entry->backoff_ms = 0;
+    portEXIT_CRITICAL(&resolver_lock);
+}
+
+void host_resolver_print()
+{
+    unsigned long now = millis();
+    Serial.printf("mDNS responder %s\n", mdns_started ? "running" : "not running");
+
+    for (int i = 0; i < HOST_RESOLVER_ENTRIES; i++)
+    {
+        // Copy out under the lock, printing is far too slow to hold it
+        HostEntry entry;
+        portENTER_CRITICAL(&resolver_lock);
+        memcpy(&entry, &entries[i], sizeof(HostEntry));
+        portEXIT_CRITICAL(&resolver_lock);
+
+        if (entry.host[0] == '\0')
+        {
+            continue;
+        }
+
+        Serial.printf("%s -> %s, %u lookups, %u failed, next lookup in %ld s\n",
+            entry.host,
+            entry.address == 0 ? "unresolved" : IPAddress(entry.address).toString().c_str(),
+            entry.lookups, entry.failures,
+            (long)(entry.retry_at - now) > 0 ? (long)(entry.retry_at - now) / 1000 : 0);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <IPAddress.h>
+#include <WString.h>
+
+/*
+ * Cache of resolved printer hosts, shared by all printer integrations.
+ * Names ending in .local are resolved through mDNS, other names through DNS. IP addresses pass through untouched.
+ * A resolved address is kept for HOST_RESOLVER_TTL_MS. A failed lookup is retried with an exponential backoff,
+ * meanwhile the last known address (if any) keeps being used.
+ */
+
+#define HOST_RESOLVER_ENTRIES 8
+#define HOST_RESOLVER_TTL_MS 300000
+#define HOST_RESOLVER_MIN_AGE_MS 10000
+#define HOST_RESOLVER_BACKOFF_MIN_MS 2000
+#define HOST_RESOLVER_BACKOFF_MAX_MS 60000
+#define HOST_RESOLVER_MDNS_TIMEOUT_MS 2000
+
+// Starts the mDNS responder, needs WiFi to be started
+void host_resolver_init();
+// False when no address is known, the caller should then hand the host name to the client itself
+bool host_resolve(const char* host, IPAddress* address);
+// For building URLs and for clients that only take a name: the cached address as text, or the host itself
+String host_resolve_string(const char* host);
+// Call after a connect to the host failed, the address may have changed. Resolves again on the next call
+void host_resolver_invalidate(const char* host);
+// Stores an address learned elsewhere, like from mDNS service discovery
+void host_resolver_seed(const char* host, IPAddress address);
+void host_resolver_print();
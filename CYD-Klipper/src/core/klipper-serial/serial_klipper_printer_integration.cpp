@@ -2,6 +2,7 @@
 #include <HardwareSerial.h>
 #include <UrlEncode.h>
 #include "../../ui/serial/serial_console.h"
+#include "../request_metrics.h"
 
 void clear_serial_buffer(bool can_rely_on_newline_terminator = true)
 {
@@ -43,15 +44,24 @@ bool make_serial_request(JsonDocument &out, int timeout_ms, HttpRequestType requ
     {
         return true;
     }
+
+    char label[REQUEST_METRICS_ENDPOINT_LENGTH];
+    snprintf(label, sizeof(label), "serial %s", endpoint);
+    RequestTiming timing;
+    request_timing_start(&timing, label);
+
     unsigned long _m = millis();
     while (!Serial.available() && millis() < _m + timeout_ms + 10) delay(1);
 
     if (!Serial.available())
     {
         Serial.println("Timeout...");
+        request_timing_finish(&timing, false);
         return false;
     }
 
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+
     Serial.readBytes(buff, 4);
     buff[3] = 0;
 
@@ -59,6 +69,7 @@ bool make_serial_request(JsonDocument &out, int timeout_ms, HttpRequestType requ
     {
         Serial.printf("Invalid error code, got char '%c'\n", buff[0]);
         clear_serial_buffer();
+        request_timing_finish(&timing, false);
         
         return false;
     }
@@ -69,13 +80,17 @@ bool make_serial_request(JsonDocument &out, int timeout_ms, HttpRequestType requ
     {
         Serial.println("Non-200 error code");
         clear_serial_buffer();
+        request_timing_finish(&timing, false);
         
         return false;
     }
 
+    // Not metered, read ahead would eat into whatever the host sends after the body. Parse includes the transfer
     auto result = deserializeJson(out, Serial);
+    request_timing_mark(&timing, RequestPhaseParse);
     Serial.printf("Deserialization result: %s\n", result.c_str());
     bool success = result == DeserializationError::Ok;
+    request_timing_finish(&timing, success);
 
     return success;
 }
@@ -291,7 +306,7 @@ Files SerialKlipperPrinter::get_files()
         return files_result;
     }
 
-    parse_file_list(doc, files, 20);
+    parse_file_list(doc, files, KLIPPER_FILE_FETCH_LIMIT);
     
     files_result.available_files = (char**)malloc(sizeof(char*) * files.size());
 
@@ -1,5 +1,7 @@
 #include "klipper_printer_integration.hpp"
 #include "../../conf/global_config.h"
+#include "../request_metrics.h"
+#include "../host_resolver.h"
 #include <HTTPClient.h>
 #include <UrlEncode.h>
 #include <ArduinoJson.h>
@@ -14,7 +16,7 @@ void KlipperPrinter::configure_http_client(HTTPClient &client, String url_part,
         client.setConnectTimeout(timeout);
     }
 
-    client.begin("http://" + String(printer_config->printer_host) + ":" + String(printer_config->klipper_port) + url_part);
+    client.begin("http://" + host_resolve_string(printer_config->printer_host) + ":" + String(printer_config->klipper_port) + url_part);
 
     if (printer_config->auth_configured) {
         client.addHeader("X-Api-Key", printer_config->printer_auth);
@@ -27,26 +29,39 @@ int KlipperPrinter::get_slicer_time_estimate_s()
         return 0;
 
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper metadata");
     configure_http_client(client, "/server/files/metadata?filename=" + urlEncode(printer_data.print_filename), true, 5000);
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code != 200) 
+    {
+        request_timing_finish(&timing, false);
         return 0;
+    }
     
     JsonDocument doc;
-    deserializeJson(doc, client.getStream());
+    MeteredStream stream(client.getStream(), &timing);
+    deserializeJson(doc, stream);
+    request_timing_mark(&timing, RequestPhaseParse);
+    request_timing_finish(&timing, true);
     return parse_slicer_time_estimate(doc);
 }
 
 bool KlipperPrinter::send_gcode(const char *gcode, bool wait)
 {
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper gcode");
     configure_http_client(client, "/printer/gcode/script?script=" + urlEncode(gcode), false, wait ? 5000 : 750);
     LOG_F(("Sending gcode: %s\n", gcode))
 
     try
     {
-        client.GET();
+        int http_code = client.GET();
+        request_timing_mark(&timing, RequestPhaseFirstByte);
+        request_timing_finish(&timing, http_code == 200);
         return true;
     }
     catch (...)
@@ -172,9 +187,13 @@ bool KlipperPrinter::connect()
 bool KlipperPrinter::fetch()
 {
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper fetch");
     configure_http_client(client, "/printer/objects/query?extruder&heater_bed&toolhead&gcode_move&virtual_sdcard&print_stats&webhooks&fan&display_status", true, 1000);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+
     if (http_code == 200)
     {
         if (printer_data.state == PrinterStateOffline)
@@ -184,13 +203,42 @@ bool KlipperPrinter::fetch()
 
         klipper_request_consecutive_fail_count = 0;
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         parse_state(doc);
+
+        // Only the shown printer keeps a socket open, the files panel can't open for the others
+        if (file_watch && get_current_printer() != this)
+        {
+            file_watch = false;
+        }
+
+        if (file_watch && watch_file_changes())
+        {
+            poll_file_changes();
+
+            if (!file_index_loaded)
+            {
+                load_file_index();
+            }
+        }
+        else if (!file_watch && file_socket.connected())
+        {
+            file_socket.disconnect();
+        }
     }
     else
     {
         klipper_request_consecutive_fail_count++;
         LOG_F(("Failed to fetch printer data: %d\n", http_code));
+        request_timing_finish(&timing, false);
+
+        if (http_code == HTTPC_ERROR_CONNECTION_REFUSED)
+        {
+            host_resolver_invalidate(printer_config->printer_host);
+        }
 
         if (klipper_request_consecutive_fail_count >= 5) 
         {
@@ -216,20 +264,28 @@ PrinterDataMinimal KlipperPrinter::fetch_min()
     data.success = true;
 
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper fetch_min");
     configure_http_client(client, "/printer/objects/query?webhooks&print_stats&virtual_sdcard", true, 1000);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+
     if (http_code == 200)
     {
+        JsonDocument doc;
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
+
         data.state = PrinterState::PrinterStateIdle;
         data.power_devices = get_power_devices_count();
-
-        JsonDocument doc;
-        deserializeJson(doc, client.getStream());
         parse_state_min(doc, &data);
     }
     else 
     {
+        request_timing_finish(&timing, false);
         data.state = PrinterState::PrinterStateOffline;
         data.power_devices = get_power_devices_count();
     }
@@ -239,7 +295,8 @@ PrinterDataMinimal KlipperPrinter::fetch_min()
 
 void KlipperPrinter::disconnect()
 {
-    // Nothing to disconnect, everything is http request based
+    // Everything but the file change notifications is http request based
+    file_socket.disconnect();
     printer_data.state = PrinterStateOffline;
 }
 
@@ -248,31 +305,45 @@ Macros KlipperPrinter::get_macros()
     HTTPClient client;
     Macros macros = {0};
 
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper macros");
     configure_http_client(client, "/printer/gcode/help", true, 1000);
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200){
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         return parse_macros(doc);
     }
 
+    request_timing_finish(&timing, false);
     return macros;
 }
 
 int KlipperPrinter::get_macros_count()
 {
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper macros");
     configure_http_client(client, "/printer/gcode/help", true, 1000);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200){
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         return parse_macros_count(doc);
     }
     else {
+        request_timing_finish(&timing, false);
         return 0;
     }
 }
@@ -286,32 +357,46 @@ PowerDevices KlipperPrinter::get_power_devices()
 {
     HTTPClient client;
     PowerDevices power_devices = {0};
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper power");
     configure_http_client(client, "/machine/device_power/devices", true, 1000);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200){
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         return parse_power_devices(doc);
     }
 
+    request_timing_finish(&timing, false);
     return power_devices;
 }
 
 int KlipperPrinter::get_power_devices_count()
 {
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper power");
     configure_http_client(client, "/machine/device_power/devices", true, 1000);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200){
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         return parse_power_devices_count(doc);
     }
     else {
+        request_timing_finish(&timing, false);
         return 0;
     }
 }
@@ -323,56 +408,190 @@ bool KlipperPrinter::set_power_device_state(const char* device_name, bool state)
     return client.POST("") == 200;
 }
 
-#define KLIPPER_FILE_FETCH_LIMIT 20
+// Without the change notifications, the index is loaded again when it is older than this
+#define KLIPPER_FILE_INDEX_MAX_AGE_MS 30000
+#define KLIPPER_FILE_SOCKET_RETRY_MS 30000
+#define KLIPPER_FILE_SOCKET_MAX_FRAMES_PER_FETCH 8
 
-Files KlipperPrinter::get_files()
+KlipperPrinter::~KlipperPrinter()
+{
+    file_socket.disconnect();
+    file_names_lent = false;
+    clear_file_index();
+    free_retired_file_names();
+}
+
+void KlipperPrinter::clear_file_index()
+{
+    for (auto file : file_index){
+        release_file_name(file.name);
+    }
+
+    file_index.clear();
+    file_index_loaded = false;
+}
+
+void KlipperPrinter::release_file_name(char* name)
+{
+    if (file_names_lent)
+    {
+        retired_file_names.push_back(name);
+    }
+    else
+    {
+        free(name);
+    }
+}
+
+void KlipperPrinter::free_retired_file_names()
+{
+    for (auto name : retired_file_names){
+        free(name);
+    }
+
+    retired_file_names.clear();
+}
+
+bool KlipperPrinter::load_file_index()
 {
-    Files files_result = {0};
     HTTPClient client;
     LOG_F(("Heap space pre-file-parse: %d bytes\n", esp_get_free_heap_size()));
-    std::list<KlipperFileSystemFile> files;
 
-    auto timer_request = millis();
-    configure_http_client(client, "/server/files/list", true, 5000);
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper files");
+    configure_http_client(client, "/server/files/list?root=gcodes", true, 5000);
 
     int http_code = client.GET();
-    auto timer_parse = millis();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
-    if (http_code == 200)
+    if (http_code != 200)
     {
-        JsonDocument doc;
-        auto parseResult = deserializeJson(doc, client.getStream());
-        LOG_F(("Json parse: %s\n", parseResult.c_str()))
-        parse_file_list(doc, files, KLIPPER_FILE_FETCH_LIMIT);
+        request_timing_finish(&timing, false);
+        return false;
     }
-    else 
+
+    clear_file_index();
+    MeteredStream stream(client.getStream(), &timing);
+    auto parseResult = parse_file_list_stream(stream, file_index, KLIPPER_FILE_FETCH_LIMIT);
+    LOG_F(("Json parse: %s\n", parseResult.c_str()))
+    request_timing_mark(&timing, RequestPhaseParse);
+    request_timing_finish(&timing, parseResult == DeserializationError::Ok);
+
+    file_index_loaded = parseResult == DeserializationError::Ok;
+    file_index_loaded_at = millis();
+
+    LOG_F(("Heap space post-file-parse: %d bytes\n", esp_get_free_heap_size()))
+    LOG_F(("Got %d files. First byte after %lums, transfer took %lums, parsing took %lums\n", file_index.size(),
+        timing.phase_us[RequestPhaseFirstByte] / 1000, timing.phase_us[RequestPhaseTransfer] / 1000, timing.phase_us[RequestPhaseParse] / 1000))
+    return file_index_loaded;
+}
+
+// Opens the notification socket when needed. Changes made while it was closed were missed, the index is loaded again
+bool KlipperPrinter::watch_file_changes()
+{
+    if (file_socket.connected())
     {
-        return files_result;
+        return true;
     }
 
-    files_result.available_files = (char**)malloc(sizeof(char*) * files.size());
+    if (file_socket_attempt != 0 && millis() - file_socket_attempt < KLIPPER_FILE_SOCKET_RETRY_MS)
+    {
+        return false;
+    }
 
-    if (files_result.available_files == NULL){
-        LOG_LN("Failed to allocate memory");
+    file_socket_attempt = millis();
+    String headers = printer_config->auth_configured ? "X-Api-Key: " + String(printer_config->printer_auth) + "\r\n" : "";
+
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper file socket");
+    bool connected = file_socket.connect(host_resolve_string(printer_config->printer_host).c_str(), printer_config->klipper_port, "/websocket", headers.c_str());
+    request_timing_mark(&timing, RequestPhaseConnect);
+    request_timing_finish(&timing, connected);
 
-        for (auto file : files){
-            free(file.name);
+    if (connected)
+    {
+        LOG_LN("File index: Listening for file changes");
+        file_index_loaded = false;
+    }
+
+    return connected;
+}
+
+// Applies pending file change notifications, Moonraker broadcasts other notifications on the same socket
+void KlipperPrinter::poll_file_changes()
+{
+    JsonDocument filter;
+    filter["method"] = true;
+    JsonObject change_filter = filter["params"][0].to<JsonObject>();
+    change_filter["action"] = true;
+    change_filter["item"]["root"] = true;
+    change_filter["item"]["path"] = true;
+    change_filter["item"]["modified"] = true;
+    change_filter["source_item"]["path"] = true;
+
+    for (int i = 0; i < KLIPPER_FILE_SOCKET_MAX_FRAMES_PER_FETCH && file_socket.poll_text_frame() > 0; i++)
+    {
+        JsonDocument doc;
+        auto parse_result = deserializeJson(doc, file_socket.frame_stream(), DeserializationOption::Filter(filter));
+        const char* method = doc["method"];
+
+        if (parse_result || method == NULL || strcmp(method, "notify_filelist_changed") != 0)
+        {
+            continue;
         }
 
+        if (file_index_loaded && !parse_file_list_change(doc, file_index, KLIPPER_FILE_FETCH_LIMIT))
+        {
+            file_index_loaded = false;
+        }
+    }
+}
+
+Files KlipperPrinter::get_files()
+{
+    Files files_result = {0};
+    file_watch = true;
+    // The list lent out before has been freed by now
+    file_names_lent = false;
+    free_retired_file_names();
+
+    if (watch_file_changes())
+    {
+        poll_file_changes();
+    }
+
+    if (!file_index_loaded || (!file_socket.connected() && millis() - file_index_loaded_at > KLIPPER_FILE_INDEX_MAX_AGE_MS))
+    {
+        if (!load_file_index())
+        {
+            return files_result;
+        }
+    }
+
+    // Only the array is handed over, names that leave the index while it is in use wait for the next call
+    files_result.available_files = (char**)malloc(sizeof(char*) * file_index.size());
+
+    if (files_result.available_files == NULL){
+        LOG_LN("Failed to allocate memory");
         return files_result;
     }
 
-    for (auto file : files){
+    for (auto file : file_index){
         files_result.available_files[files_result.count++] = file.name;
     }
 
+    file_names_lent = true;
+    files_result.names_borrowed = true;
     files_result.success = true;
-
-    LOG_F(("Heap space post-file-parse: %d bytes\n", esp_get_free_heap_size()))
-    LOG_F(("Got %d files. Request took %dms, parsing took %dms\n", files.size(), timer_parse - timer_request, millis() - timer_parse))
     return files_result;    
 }
 
+// The next fetch closes the socket. Without it the index goes stale and is loaded again once the panel reopens
+void KlipperPrinter::stop_watching_files()
+{
+    file_watch = false;
+}
+
 bool KlipperPrinter::start_file(const char *filename)
 {
     HTTPClient client;
@@ -407,6 +626,8 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
 {
     Thumbnail thumbnail = {0};
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper thumbnails");
     configure_http_client(client, "/server/files/thumbnails?filename=" + urlEncode(gcode_filename), true, 1000);
     char* img_filename_path = NULL;
     unsigned char* data_png = NULL;
@@ -415,17 +636,21 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
     try 
     {
         http_code = client.GET();
+        request_timing_mark(&timing, RequestPhaseFirstByte);
     }
     catch (...)
     {
         LOG_LN("Exception while fetching gcode img location");
+        request_timing_finish(&timing, false);
         return thumbnail;
     }
 
     if (http_code == 200)
     {
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
         img_filename_path = parse_thumbnails(doc);
     }
     else 
@@ -433,6 +658,8 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
         LOG_F(("Failed to fetch gcode image data: %d\n", http_code))
     }
 
+    request_timing_finish(&timing, http_code == 200);
+
     if (img_filename_path == NULL)
     {
         LOG_LN("No compatible thumbnail found");
@@ -445,16 +672,19 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
 
     client.end();
 
+    request_timing_start(&timing, "klipper thumbnail png");
     configure_http_client(client, "/server/files/gcodes/" + urlEncode(img_filename_path), false, 2000);
 
     http_code = 0;
     try 
     {
         http_code = client.GET();
+        request_timing_mark(&timing, RequestPhaseFirstByte);
     }
     catch (...)
     {
         LOG_LN("Exception while fetching gcode img");
+        request_timing_finish(&timing, false);
         return thumbnail;
     }
 
@@ -464,6 +694,7 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
         if (len <= 0)
         {
             LOG_LN("No gcode img data");
+            request_timing_finish(&timing, false);
             return thumbnail;
         }
 
@@ -471,7 +702,11 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
 
         if (data_png != NULL)
         {
-            if (len != client.getStream().readBytes(data_png, len))
+            size_t read = client.getStream().readBytes(data_png, len);
+            request_timing_mark(&timing, RequestPhaseTransfer);
+            request_timing_add_bytes(&timing, read);
+
+            if (len != read)
             {
                 LOG_LN("Failed to read gcode img data");
                 free(data_png);
@@ -485,6 +720,7 @@ Thumbnail KlipperPrinter::get_32_32_png_image_thumbnail(const char* gcode_filena
         }
     }
 
+    request_timing_finish(&timing, thumbnail.success);
     free(img_filename_path);
     return thumbnail;
 }
@@ -495,15 +731,20 @@ KlipperConnectionStatus connection_test_klipper(PrinterConfiguration* config)
 
     client.setTimeout(1000);
     client.setConnectTimeout(1000);
-    client.begin("http://" + String(config->printer_host) + ":" + String(config->klipper_port) + "/printer/info");
+    client.begin("http://" + host_resolve_string(config->printer_host) + ":" + String(config->klipper_port) + "/printer/info");
 
     if (config->auth_configured) {
         client.addHeader("X-Api-Key", config->printer_auth);
     }
 
+    RequestTiming timing;
+    request_timing_start(&timing, "klipper info");
+
     int http_code;
     try {
         http_code = client.GET();
+        request_timing_mark(&timing, RequestPhaseFirstByte);
+        request_timing_finish(&timing, http_code == 200);
 
         if (http_code == 403)
         {
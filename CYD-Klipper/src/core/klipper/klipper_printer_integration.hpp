@@ -1,10 +1,19 @@
 #pragma once
 
 #include "../printer_integration.hpp"
+#include "../common/websocket_client.h"
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <list>
 
+// Newest files kept of a library. The files panel only creates widgets for the visible ones and borrows
+// the names from the index, a name takes about 70 bytes of heap
+#ifdef BOARD_HAS_PSRAM
+#define KLIPPER_FILE_FETCH_LIMIT 200
+#else
+#define KLIPPER_FILE_FETCH_LIMIT 100
+#endif
+
 typedef struct {
     char* name;
     float modified;
@@ -15,7 +24,24 @@ class KlipperPrinter : public BasePrinter
     private:
         unsigned int slicer_estimated_print_time_s{};
         unsigned int last_slicer_time_query{};
+        // Newest files first, kept current from Moonraker's file change notifications while the files are being watched
+        std::list<KlipperFileSystemFile> file_index;
+        bool file_index_loaded{};
+        unsigned long file_index_loaded_at{};
+        // Set while the files panel exists, cleared by the LVGL task when it is deleted
+        volatile bool file_watch{};
+        WebSocketClient file_socket;
+        unsigned long file_socket_attempt{};
+        // Names lent out by get_files that left the index since, freed on the next get_files
+        std::list<char*> retired_file_names;
+        bool file_names_lent{};
+
         void configure_http_client(HTTPClient &client, String url_part, bool stream, int timeout);
+        bool load_file_index();
+        void clear_file_index();
+        void free_retired_file_names();
+        bool watch_file_changes();
+        void poll_file_changes();
 
     protected:
         unsigned char lock_absolute_relative_mode_swap{};
@@ -32,7 +58,12 @@ class KlipperPrinter : public BasePrinter
         int parse_macros_count(JsonDocument &in);
         PowerDevices parse_power_devices(JsonDocument &in);
         int parse_power_devices_count(JsonDocument &in);
+        // Frees a name dropped from a file list, or keeps it until the next get_files while get_files lent it out
+        void release_file_name(char* name);
+        bool insert_file(std::list<KlipperFileSystemFile> &files, const char *path, float modified, int fetch_limit);
         void parse_file_list(JsonDocument &in, std::list<KlipperFileSystemFile> &files, int fetch_limit);
+        DeserializationError parse_file_list_stream(Stream &in, std::list<KlipperFileSystemFile> &files, int fetch_limit);
+        bool parse_file_list_change(JsonDocument &in, std::list<KlipperFileSystemFile> &files, int fetch_limit);
         char *parse_thumbnails(JsonDocument &in);
 
     public:
@@ -59,6 +90,8 @@ class KlipperPrinter : public BasePrinter
             printer_data.error_screen_features = PrinterFeatureRestart | PrinterFeatureFirmwareRestart;
         }
 
+        ~KlipperPrinter();
+
         bool move_printer(const char* axis, float amount, bool relative);
         bool execute_feature(PrinterFeatures feature);
         virtual bool connect();
@@ -72,6 +105,7 @@ class KlipperPrinter : public BasePrinter
         virtual int get_power_devices_count();
         virtual bool set_power_device_state(const char* device_name, bool state);
         virtual Files get_files();
+        virtual void stop_watching_files();
         virtual bool start_file(const char* filename);
         virtual Thumbnail get_32_32_png_image_thumbnail(const char* gcode_filename);
         bool set_target_temperature(PrinterTemperatureDevice device, unsigned int temperature);
@@ -304,52 +304,161 @@ int KlipperPrinter::parse_power_devices_count(JsonDocument &in)
     return count;
 }
 
+// Keeps the list ordered newest first and at most fetch_limit long. Returns false when the file is too old to fit
+bool KlipperPrinter::insert_file(std::list<KlipperFileSystemFile> &files, const char *path, float modified, int fetch_limit)
+{
+    KlipperFileSystemFile f = {0};
+    auto file_iter = files.begin();
+
+    while (file_iter != files.end())
+    {
+        if ((*file_iter).modified < modified)
+            break;
+
+        file_iter++;
+    }
+
+    if (file_iter == files.end() && files.size() >= fetch_limit)
+        return false;
+
+    f.name = (char *)malloc(strlen(path) + 1);
+    if (f.name == NULL)
+    {
+        LOG_LN("Failed to allocate memory");
+        return false;
+    }
+    strcpy(f.name, path);
+    f.modified = modified;
+
+    if (file_iter != files.end())
+        files.insert(file_iter, f);
+    else
+        files.push_back(f);
+
+    if (files.size() > fetch_limit)
+    {
+        auto last_entry = files.back();
+
+        if (last_entry.name != NULL)
+            release_file_name(last_entry.name);
+
+        files.pop_back();
+    }
+
+    return true;
+}
+
 void KlipperPrinter::parse_file_list(JsonDocument &in, std::list<KlipperFileSystemFile> &files, int fetch_limit)
 {
     JsonArray result = in["result"];
 
     for (JsonObject file : result)
     {
-        KlipperFileSystemFile f = {0};
         const char *path = file["path"];
         float modified = file["modified"];
-        auto file_iter = files.begin();
+        insert_file(files, path, modified, fetch_limit);
+    }
+}
 
-        while (file_iter != files.end())
-        {
-            if ((*file_iter).modified < modified)
-                break;
+// Parses a /server/files/list response one file at a time, so memory use doesn't grow with the size of the library
+DeserializationError KlipperPrinter::parse_file_list_stream(Stream &in, std::list<KlipperFileSystemFile> &files, int fetch_limit)
+{
+    JsonDocument filter;
+    filter["path"] = true;
+    filter["modified"] = true;
 
-            file_iter++;
-        }
+    if (!in.find("\"result\"") || !in.find("["))
+    {
+        return DeserializationError::InvalidInput;
+    }
 
-        if (file_iter == files.end() && files.size() >= fetch_limit)
-            continue;
+    while (isspace(in.peek()))
+    {
+        in.read();
+    }
+
+    // An empty library
+    if (in.peek() == ']')
+    {
+        return DeserializationError::Ok;
+    }
+
+    do
+    {
+        JsonDocument file;
+        auto result = deserializeJson(file, in, DeserializationOption::Filter(filter));
 
-        f.name = (char *)malloc(strlen(path) + 1);
-        if (f.name == NULL)
+        if (result)
         {
-            LOG_LN("Failed to allocate memory");
-            continue;
+            return result;
         }
-        strcpy(f.name, path);
-        f.modified = modified;
 
-        if (file_iter != files.end())
-            files.insert(file_iter, f);
-        else
-            files.push_back(f);
+        const char *path = file["path"];
 
-        if (files.size() > fetch_limit)
+        if (path != NULL)
         {
-            auto last_entry = files.back();
+            insert_file(files, path, file["modified"], fetch_limit);
+        }
+    } while (in.findUntil(",", "]"));
 
-            if (last_entry.name != NULL)
-                free(last_entry.name);
+    return DeserializationError::Ok;
+}
 
-            files.pop_back();
+// Applies a notify_filelist_changed message to the file index. Returns false when the index can't follow the change
+// and has to be loaded again
+bool KlipperPrinter::parse_file_list_change(JsonDocument &in, std::list<KlipperFileSystemFile> &files, int fetch_limit)
+{
+    JsonObject change = in["params"][0];
+    const char *action = change["action"];
+    const char *root = change["item"]["root"];
+    const char *path = change["item"]["path"];
+    const char *source_path = change["source_item"]["path"];
+
+    if (action == NULL || root == NULL || strcmp(root, "gcodes") != 0)
+    {
+        return true;
+    }
+
+    if (strcmp(action, "create_dir") == 0)
+    {
+        return true;
+    }
+
+    // Everything below a moved or deleted directory changed, the notification doesn't list it
+    if (strcmp(action, "create_file") != 0 && strcmp(action, "modify_file") != 0 && strcmp(action, "delete_file") != 0 && strcmp(action, "move_file") != 0)
+    {
+        return false;
+    }
+
+    bool removed = false;
+    const char *removed_path = strcmp(action, "move_file") == 0 ? source_path : path;
+
+    for (auto file_iter = files.begin(); removed_path != NULL && file_iter != files.end(); file_iter++)
+    {
+        if (strcmp((*file_iter).name, removed_path) == 0)
+        {
+            release_file_name((*file_iter).name);
+            files.erase(file_iter);
+            removed = true;
+            break;
         }
     }
+
+    if (strcmp(action, "delete_file") == 0)
+    {
+        LOG_F(("File index: Removed %s\n", path))
+        // The next older file, left out when the index was full, moves up into it
+        return !removed || files.size() + 1 < fetch_limit;
+    }
+
+    if (path == NULL || path[0] == '.' || strstr(path, "/.") != NULL)
+    {
+        return true;
+    }
+
+    LOG_F(("File index: Added %s\n", path))
+    insert_file(files, path, change["item"]["modified"], fetch_limit);
+    return true;
 }
 
 char *KlipperPrinter::parse_thumbnails(JsonDocument &in)
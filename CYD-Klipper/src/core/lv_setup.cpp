@@ -5,6 +5,9 @@
 #include "../ui/ui_utils.h"
 #include <Esp.h>
 #include "../ui/serial/serial_console.h"
+#include "data_setup.h"
+#include "touch_filter.h"
+#include <WiFi.h>
 
 #ifndef CPU_FREQ_HIGH
 #define CPU_FREQ_HIGH 240
@@ -13,9 +16,17 @@
 #define CPU_FREQ_LOW 80
 #endif
 
+// Rough supply current of the whole board per power state, only used for the estimates of the 'power' command
+#ifndef POWER_ESTIMATE_AWAKE_MA
+#define POWER_ESTIMATE_AWAKE_MA 130
+#endif
+#ifndef POWER_ESTIMATE_ASLEEP_MA
+#define POWER_ESTIMATE_ASLEEP_MA 40
+#endif
+
 unsigned long last_milis = 0;
 
-void lv_handler()
+unsigned int lv_handler()
 {
 #ifndef CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
     if (digitalRead(0) == HIGH)
@@ -31,7 +42,7 @@ void lv_handler()
 #endif
 
     lv_timer_handler();
-    lv_task_handler();
+    return lv_task_handler();
 }
 
 typedef void (*lv_indev_drv_read_cb_t)(struct _lv_indev_drv_t * indev_drv, lv_indev_data_t * data);
@@ -42,44 +53,80 @@ lv_coord_t point[2] = {0};
 
 static lv_indev_drv_read_cb_t original_touch_driver = NULL;
 
+static uint32_t redrawn_px = 0;
+static unsigned long redrawn_px_since = 0;
+static unsigned long long redrawn_px_total = 0;
+
+// Reports how much of the screen gets redrawn per second while debug logging is on
+void lv_monitor_redrawn_area(lv_disp_drv_t * disp_drv, uint32_t time, uint32_t px)
+{
+    redrawn_px_total += px;
+
+    if (!temporary_config.debug)
+    {
+        return;
+    }
+
+    redrawn_px += px;
+    unsigned long elapsed = millis() - redrawn_px_since;
+
+    if (elapsed >= 1000)
+    {
+        LOG_F(("Redrawn area: %lu px/s\n", (unsigned long)((uint64_t)redrawn_px * 1000 / elapsed)))
+        redrawn_px = 0;
+        redrawn_px_since = millis();
+    }
+}
+
+static bool calibration_touch_down = false;
+static lv_coord_t calibration_touch_point[2] = {0};
+
+// Reports where a touch started once the finger lifts, without waiting inside the read callback
 void lv_touch_intercept_calibration(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) 
 {
     original_touch_driver(indev_driver, data);
 
     if (data->state == LV_INDEV_STATE_PR){
-        lv_coord_t local_point[] = {data->point.x, data->point.y};
-        while (data->state == LV_INDEV_STATE_PR){
-            original_touch_driver(indev_driver, data);
-            delay(20);    
+        if (!calibration_touch_down){
+            calibration_touch_down = true;
+            calibration_touch_point[0] = data->point.x;
+            calibration_touch_point[1] = data->point.y;
         }
-
-        point[0] = local_point[0];
-        point[1] = local_point[1];
+    }
+    else if (calibration_touch_down){
+        calibration_touch_down = false;
+        point[0] = calibration_touch_point[0];
+        point[1] = calibration_touch_point[1];
     }
 
     data->state = LV_INDEV_STATE_REL;
 }
 
+static TouchFilter touch_filter = {};
+
 void lv_touch_intercept(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) 
 {
     original_touch_driver(indev_driver, data);
-    
-    if (data->state == LV_INDEV_STATE_PR) {
-        if (is_screen_asleep()) {
-            while (data->state == LV_INDEV_STATE_PR) {
-                original_touch_driver(indev_driver, data);
-                delay(20);
-            }
-
-            data->state = LV_INDEV_STATE_REL;
-            delay(300); // Some screens don't debounce their signal properly
-        }
+    bool pressed = data->state == LV_INDEV_STATE_PR;
 
-        screen_timer_wake();
 #ifndef CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
+    if (pressed) {
         data->point.x = round((data->point.x * global_config.screen_cal_x_mult) + global_config.screen_cal_x_offset);
         data->point.y = round((data->point.y * global_config.screen_cal_y_mult) + global_config.screen_cal_y_offset);
+    }
 #endif // CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
+
+    switch (touch_filter_update(&touch_filter, pressed, is_screen_asleep(), millis())) {
+        case TouchFilterActionPress:
+            screen_timer_wake();
+            break;
+        case TouchFilterActionWake:
+            screen_timer_wake();
+            data->state = LV_INDEV_STATE_REL;
+            break;
+        default:
+            data->state = LV_INDEV_STATE_REL;
+            break;
     }
 }
 
@@ -197,6 +244,24 @@ void set_screen_brightness()
         screen_setBrightness(global_config.brightness);
 }
 
+static unsigned long power_state_ms[2] = {0};
+static unsigned long power_state_since = 0;
+
+static void power_state_account()
+{
+    unsigned long now = millis();
+    power_state_ms[is_screen_in_sleep] += now - power_state_since;
+    power_state_since = now;
+}
+
+static void set_wifi_power_save(wifi_ps_type_t type)
+{
+    if (WiFi.getMode() != WIFI_OFF)
+    {
+        WiFi.setSleep(type);
+    }
+}
+
 void screen_timer_wake()
 {
 #ifndef CYD_SCREEN_DISABLE_TIMEOUT
@@ -206,12 +271,18 @@ void screen_timer_wake()
         return;
     }
 
+    power_state_account();
     is_screen_in_sleep = false;
-    set_screen_brightness();
 
     // Reset cpu freq
     setCpuFrequencyMhz(CPU_FREQ_HIGH);
-    LOG_F(("CPU Speed: %d MHz\n", ESP.getCpuFreqMHz()))
+    set_wifi_power_save(WIFI_PS_MIN_MODEM);
+    lv_timer_resume(_lv_disp_get_refr_timer(lv_disp_get_default()));
+    set_screen_brightness();
+
+    // Stop waiting on the slow sleep heartbeat
+    data_poll_now();
+    LOG_F(("Awake: CPU Speed: %d MHz, estimated %d mA\n", ESP.getCpuFreqMHz(), POWER_ESTIMATE_AWAKE_MA))
 #endif
 }
 
@@ -219,14 +290,34 @@ void screen_timer_sleep(lv_timer_t *timer)
 {
 #ifndef CYD_SCREEN_DISABLE_TIMEOUT
     screen_setBrightness(0);
+    power_state_account();
     is_screen_in_sleep = true;
 
+    // Nothing is visible, so stop rendering. Touch input is still read to wake up the screen
+    lv_timer_pause(_lv_disp_get_refr_timer(lv_disp_get_default()));
+
     // Screen is off, no need to make the cpu run fast, the user won't notice ;)
     setCpuFrequencyMhz(CPU_FREQ_LOW);
-    LOG_F(("CPU Speed: %d MHz\n", ESP.getCpuFreqMHz()))
+    set_wifi_power_save(WIFI_PS_MAX_MODEM);
+    LOG_F(("Asleep: CPU Speed: %d MHz, estimated %d mA\n", ESP.getCpuFreqMHz(), POWER_ESTIMATE_ASLEEP_MA))
 #endif
 }
 
+void print_power_stats()
+{
+    power_state_account();
+    const char* names[] = { "Awake", "Asleep" };
+    const int estimates_ma[] = { POWER_ESTIMATE_AWAKE_MA, POWER_ESTIMATE_ASLEEP_MA };
+
+    Serial.printf("Power state: %s, CPU Speed: %d MHz\n", names[is_screen_in_sleep], ESP.getCpuFreqMHz());
+
+    for (int i = 0; i < 2; i++)
+    {
+        float hours = power_state_ms[i] / 3600000.0f;
+        Serial.printf("%-8s %8lu s, estimated %3d mA, %7.1f mAh\n", names[i], power_state_ms[i] / 1000, estimates_ma[i], hours * estimates_ma[i]);
+    }
+}
+
 void screen_timer_setup()
 {
     screen_sleep_timer = lv_timer_create(screen_timer_sleep, global_config.screen_timeout * 1000 * 60, NULL);
@@ -287,6 +378,12 @@ void lv_setup()
 
     set_color_scheme();
 
+    lv_disp_t * display = lv_disp_get_default();
+    if (display->driver->monitor_cb == NULL)
+    {
+        display->driver->monitor_cb = lv_monitor_redrawn_area;
+    }
+
 #ifndef CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
     lv_do_calibration();
 #endif // CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
@@ -298,6 +395,24 @@ void lv_setup()
     lv_png_init();
 }
 
+void lv_calibrate_if_needed()
+{
+#ifndef CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
+    if (global_config.screen_calibrated)
+    {
+        return;
+    }
+
+    lv_do_calibration();
+    lv_indev_get_next(NULL)->driver->read_cb = lv_touch_intercept;
+#endif // CYD_SCREEN_DISABLE_TOUCH_CALIBRATION
+}
+
+unsigned long long get_redrawn_px_total()
+{
+    return redrawn_px_total;
+}
+
 bool is_screen_asleep()
 {
     return is_screen_in_sleep;
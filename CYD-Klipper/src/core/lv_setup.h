@@ -7,5 +7,12 @@ void screen_timer_start();
 void screen_timer_stop();
 void set_color_scheme();
 void lv_setup();
+// Runs the touch calibration again when it was reset since boot. Blocks until the user is done
+void lv_calibrate_if_needed();
 bool is_screen_asleep();
-void lv_handler();
\ No newline at end of file
+// Pixels redrawn since boot, stays 0 when the screen driver installed its own monitor callback
+unsigned long long get_redrawn_px_total();
+// Prints time spent awake and asleep, with estimated current draw
+void print_power_stats();
+// Returns how many ms LVGL can idle before it has work again
+unsigned int lv_handler();
\ No newline at end of file
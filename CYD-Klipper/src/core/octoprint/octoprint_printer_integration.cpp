@@ -1,5 +1,7 @@
 #include "octoprint_printer_integration.hpp"
 #include "../../conf/global_config.h"
+#include "../request_metrics.h"
+#include "../host_resolver.h"
 #include <HTTPClient.h>
 #include <UrlEncode.h>
 #include <ArduinoJson.h>
@@ -14,6 +16,14 @@ const char* COMMAND_PAUSE_PRINT = "{\"command\":\"pause\",\"action\":\"pause\"}"
 const char* COMMAND_RESUME_PRINT = "{\"command\":\"pause\",\"action\":\"resume\"}";
 const char* COMMAND_EXTRUDE = "{\"command\":\"extrude\",\"amount\":25}";
 const char* COMMAND_RETRACT = "{\"command\":\"extrude\",\"amount\":-25}";
+const char* COMMAND_PASSIVE_LOGIN = "{\"passive\":true}";
+
+// OctoPrint pushes 'current' messages every 0.5s * throttle
+#define OCTO_PUSH_THROTTLE 2
+// Without a pushed message for this long, fetch falls back to polling over HTTP
+#define OCTO_PUSH_STALE_MS 10000
+#define OCTO_PUSH_RETRY_MS 30000
+#define OCTO_PUSH_MAX_FRAMES_PER_FETCH 8
 
 void configure_http_client(HTTPClient &client, String url_part, bool stream, int timeout, PrinterConfiguration* printer_config)
 {
@@ -24,7 +34,7 @@ void configure_http_client(HTTPClient &client, String url_part, bool stream, int
         client.setConnectTimeout(timeout);
     }
 
-    client.begin("http://" + String(printer_config->printer_host) + ":" + String(printer_config->klipper_port) + url_part);
+    client.begin("http://" + host_resolve_string(printer_config->printer_host) + ":" + String(printer_config->klipper_port) + url_part);
 
     if (printer_config->auth_configured) {
         client.addHeader("X-Api-Key", printer_config->printer_auth);
@@ -40,8 +50,12 @@ bool OctoPrinter::get_request(const char* endpoint, int timeout_ms)
         timeout_ms = 500;
     }
 
+    RequestTiming timing;
+    request_timing_start(&timing, "octo get");
     configure_http_client(client, endpoint, false, timeout_ms, printer_config);
     int result = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+    request_timing_finish(&timing, result >= 200 && result < 300);
     return result >= 200 && result < 300;
 }
 
@@ -55,6 +69,8 @@ bool OctoPrinter::post_request(const char* endpoint, const char* body, int timeo
     }
 
     LOG_F(("POST >>> %s %s\n", endpoint, body));
+    RequestTiming timing;
+    request_timing_start(&timing, "octo post");
     configure_http_client(client, endpoint, false, timeout_ms, printer_config);
 
     if (body[0] == '{' || body[0] == '[')
@@ -64,6 +80,8 @@ bool OctoPrinter::post_request(const char* endpoint, const char* body, int timeo
 
     int http_code = client.POST(body);
     bool result = http_code >= 200 && http_code < 300;
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+    request_timing_finish(&timing, result);
     LOG_F(("<<< %d\n", http_code));
     return result;
 }
@@ -169,31 +187,177 @@ bool OctoPrinter::connect()
     return connection_test_octoprint(printer_config) == OctoConnectionStatus::OctoConnectOk;
 }
 
+bool OctoPrinter::push_open()
+{
+    push_last_attempt = millis();
+
+    HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "octo login");
+    configure_http_client(client, "/api/login", true, 1000, printer_config);
+    client.addHeader("Content-Type", "application/json");
+
+    bool logged_in = client.POST(COMMAND_PASSIVE_LOGIN) == 200;
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+    request_timing_finish(&timing, logged_in);
+
+    if (!logged_in)
+    {
+        LOG_LN("OctoPrint push: Passive login failed");
+        return false;
+    }
+
+    JsonDocument filter;
+    filter["name"] = true;
+    filter["session"] = true;
+
+    JsonDocument doc;
+    if (deserializeJson(doc, client.getStream(), DeserializationOption::Filter(filter)))
+    {
+        LOG_LN("OctoPrint push: Failed to parse login response");
+        return false;
+    }
+
+    const char* name = doc["name"];
+    const char* session = doc["session"];
+
+    if (name == NULL || session == NULL)
+    {
+        LOG_LN("OctoPrint push: Login response has no session");
+        return false;
+    }
+
+    request_timing_start(&timing, "octo push connect");
+    bool connected = push_socket.connect(host_resolve_string(printer_config->printer_host).c_str(), printer_config->klipper_port, "/sockjs/websocket");
+    request_timing_mark(&timing, RequestPhaseConnect);
+    request_timing_finish(&timing, connected);
+
+    if (!connected)
+    {
+        return false;
+    }
+
+    char buff[128];
+    JsonDocument auth;
+    auth["auth"] = String(name) + ":" + session;
+
+    if (serializeJson(auth, buff, sizeof(buff)) >= sizeof(buff))
+    {
+        push_socket.disconnect();
+        return false;
+    }
+
+    bool result = push_socket.send_text(buff);
+    sprintf(buff, "{\"throttle\":%d}", OCTO_PUSH_THROTTLE);
+    result = result && push_socket.send_text(buff);
+
+    if (!result)
+    {
+        push_socket.disconnect();
+        return false;
+    }
+
+    LOG_LN("OctoPrint push: Connected");
+    return true;
+}
+
+// Drains pending push messages. Returns true when pushed data is recent enough to skip polling
+bool OctoPrinter::push_poll()
+{
+    JsonDocument filter;
+    JsonObject current_filter = filter["current"].to<JsonObject>();
+    current_filter["state"] = true;
+    current_filter["job"] = true;
+    current_filter["progress"] = true;
+    current_filter["temps"] = true;
+    JsonObject history_filter = filter["history"].to<JsonObject>();
+    history_filter["state"] = true;
+    history_filter["job"] = true;
+    history_filter["progress"] = true;
+
+    for (int i = 0; i < OCTO_PUSH_MAX_FRAMES_PER_FETCH && push_socket.poll_text_frame() > 0; i++)
+    {
+        RequestTiming timing;
+        request_timing_start(&timing, "octo push message");
+        JsonDocument doc;
+        MeteredStream stream(push_socket.frame_stream(), &timing);
+        auto parse_result = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, parse_result == DeserializationError::Ok);
+
+        if (parse_result)
+        {
+            LOG_F(("OctoPrint push: Json parse: %s\n", parse_result.c_str()))
+            continue;
+        }
+
+        JsonObject current = doc.containsKey("current") ? doc["current"] : doc["history"];
+
+        if (!current.isNull())
+        {
+            parse_push_current(current);
+            push_last_message = millis();
+        }
+    }
+
+    return push_socket.connected() && push_last_message != 0 && millis() - push_last_message < OCTO_PUSH_STALE_MS;
+}
+
 bool OctoPrinter::fetch()
+{
+    if (!push_socket.connected() && (push_last_attempt == 0 || millis() - push_last_attempt > OCTO_PUSH_RETRY_MS))
+    {
+        push_open();
+    }
+
+    if (push_socket.connected() && push_poll())
+    {
+        request_consecutive_fail_count = 0;
+        return true;
+    }
+
+    return fetch_http();
+}
+
+bool OctoPrinter::fetch_http()
 {
     HTTPClient client;
     HTTPClient client2;
+    RequestTiming timing;
+    request_timing_start(&timing, "octo printer");
     configure_http_client(client, "/api/printer", true, 1000, printer_config);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200)
     {
         no_printer = false;
         request_consecutive_fail_count = 0;
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, true);
         parse_printer_status(doc);
 
         doc.clear();
+        request_timing_start(&timing, "octo job");
         configure_http_client(client2, "/api/job", true, 1000, printer_config);
-        if (client2.GET() == 200)
+        bool job_ok = client2.GET() == 200;
+        request_timing_mark(&timing, RequestPhaseFirstByte);
+
+        if (job_ok)
         {
-            deserializeJson(doc, client2.getStream());
+            MeteredStream job_stream(client2.getStream(), &timing);
+            deserializeJson(doc, job_stream);
+            request_timing_mark(&timing, RequestPhaseParse);
+            request_timing_finish(&timing, true);
             parse_job_state(doc);
         }
         else
         {
+            request_timing_finish(&timing, false);
             printer_data.state = PrinterStateOffline;
             return false;
         }
@@ -202,14 +366,23 @@ bool OctoPrinter::fetch()
     {
         no_printer = true;
         JsonDocument doc;
-        deserializeJson(doc, client.getStream());
+        MeteredStream stream(client.getStream(), &timing);
+        deserializeJson(doc, stream);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, false);
         parse_error(doc);
     }
     else 
     {
+        request_timing_finish(&timing, false);
         request_consecutive_fail_count++;
         LOG_LN("Failed to fetch printer data");
 
+        if (http_code == HTTPC_ERROR_CONNECTION_REFUSED)
+        {
+            host_resolver_invalidate(printer_config->printer_host);
+        }
+
         if (request_consecutive_fail_count >= 5) 
         {
             printer_data.state = PrinterStateOffline;
@@ -227,11 +400,22 @@ PrinterDataMinimal OctoPrinter::fetch_min()
     min.print_progress = 0;
     min.power_devices = 0;
     min.state = PrinterState::PrinterStateOffline;
+
+    if (push_socket.connected() && push_poll())
+    {
+        min.state = printer_data.state;
+        min.print_progress = printer_data.print_progress;
+        return min;
+    }
     
     {
         HTTPClient client;
+        RequestTiming timing;
+        request_timing_start(&timing, "octo printer");
         configure_http_client(client, "/api/printer", true, 1000, printer_config);
         int http_code = client.GET();
+        request_timing_mark(&timing, RequestPhaseFirstByte);
+        request_timing_finish(&timing, http_code == 200);
 
         if (http_code == 200)
         {
@@ -252,9 +436,14 @@ PrinterDataMinimal OctoPrinter::fetch_min()
 
     {
         HTTPClient client;
+        RequestTiming timing;
+        request_timing_start(&timing, "octo job");
         configure_http_client(client, "/api/job", true, 1000, printer_config);
+        bool job_ok = client.GET() == 200;
+        request_timing_mark(&timing, RequestPhaseFirstByte);
+        request_timing_finish(&timing, job_ok);
 
-        if (client.GET() == 200)
+        if (job_ok)
         {
             JsonDocument doc;
             deserializeJson(doc, client.getStream());
@@ -271,6 +460,8 @@ PrinterDataMinimal OctoPrinter::fetch_min()
 
 void OctoPrinter::disconnect()
 {
+    push_socket.disconnect();
+    push_last_message = 0;
 }
 
 const char* MACRO_AUTOLEVEL = "Auto-Level (G28+G29)";
@@ -350,21 +541,26 @@ Files OctoPrinter::get_files()
     filter["files"][0]["date"] = true;
     filter["files"][0]["origin"] = true;
 
-    auto timer_request = millis();
+    RequestTiming timing;
+    request_timing_start(&timing, "octo files");
     configure_http_client(client, "/api/files?recursive=true", true, 5000, printer_config);
 
     int http_code = client.GET();
-    auto timer_parse = millis();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
 
     if (http_code == 200)
     {
         JsonDocument doc;
-        auto parseResult = deserializeJson(doc, client.getStream(), DeserializationOption::Filter(filter));
+        MeteredStream stream(client.getStream(), &timing);
+        auto parseResult = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
         LOG_F(("Json parse: %s\n", parseResult.c_str()))
         parse_file_list(doc, files, OCTO_FILE_FETCH_LIMIT);
+        request_timing_mark(&timing, RequestPhaseParse);
+        request_timing_finish(&timing, parseResult == DeserializationError::Ok);
     }
     else 
     {
+        request_timing_finish(&timing, false);
         return files_result;
     }
 
@@ -387,7 +583,8 @@ Files OctoPrinter::get_files()
     files_result.success = true;
 
     LOG_F(("Heap space post-file-parse: %d bytes\n", esp_get_free_heap_size()))
-    LOG_F(("Got %d files. Request took %dms, parsing took %dms\n", files.size(), timer_parse - timer_request, millis() - timer_parse))
+    LOG_F(("Got %d files. First byte after %lums, transfer took %lums, parsing took %lums\n", files.size(),
+        timing.phase_us[RequestPhaseFirstByte] / 1000, timing.phase_us[RequestPhaseTransfer] / 1000, timing.phase_us[RequestPhaseParse] / 1000))
     return files_result;   
 
     return {};
@@ -432,9 +629,13 @@ bool OctoPrinter::set_target_temperature(PrinterTemperatureDevice device, unsign
 OctoConnectionStatus connection_test_octoprint(PrinterConfiguration* config)
 {
     HTTPClient client;
+    RequestTiming timing;
+    request_timing_start(&timing, "octo version");
     configure_http_client(client, "/api/version", false, 1000, config);
 
     int http_code = client.GET();
+    request_timing_mark(&timing, RequestPhaseFirstByte);
+    request_timing_finish(&timing, http_code == 200);
     if (http_code == 200)
     {
         return OctoConnectionStatus::OctoConnectOk;
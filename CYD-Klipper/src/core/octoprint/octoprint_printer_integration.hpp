@@ -1,4 +1,5 @@
 #include "../printer_integration.hpp"
+#include "../common/websocket_client.h"
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <list>
@@ -13,12 +14,20 @@ class OctoPrinter : public BasePrinter
     protected:
         bool no_printer = false;
         unsigned char request_consecutive_fail_count{};
+        WebSocketClient push_socket;
+        unsigned long push_last_message{};
+        unsigned long push_last_attempt{};
+
+        bool push_open();
+        bool push_poll();
+        bool fetch_http();
 
         void parse_printer_status(JsonDocument& in);
         PrinterState parse_printer_state(JsonDocument& in);
         void parse_job_state(JsonDocument& in);
         float parse_job_state_progress(JsonDocument& in);
         void parse_error(JsonDocument& in);
+        void parse_push_current(JsonObject current);
         void parse_file_list(JsonDocument &in, std::list<OctoFileSystemFile> &files, int fetch_limit);
 
         bool get_request(const char* endpoint, int timeout_ms = 1000);
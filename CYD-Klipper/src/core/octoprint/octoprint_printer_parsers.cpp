@@ -93,6 +93,28 @@ void OctoPrinter::parse_job_state(JsonDocument& in)
     printer_data.remaining_time_s = progress["printTimeLeft"];
 }
 
+// Push messages carry the /api/printer and /api/job payloads in a different shape
+void OctoPrinter::parse_push_current(JsonObject current)
+{
+    JsonDocument doc;
+    doc["state"] = current["state"];
+
+    // Temperatures are only included when new readings came in since the last message
+    JsonArray temps = current["temps"];
+    if (temps.size() > 0)
+    {
+        doc["temperature"] = temps[temps.size() - 1];
+    }
+
+    no_printer = !current["state"]["flags"]["operational"].as<bool>();
+    parse_printer_status(doc);
+
+    doc.clear();
+    doc["job"] = current["job"];
+    doc["progress"] = current["progress"];
+    parse_job_state(doc);
+}
+
 float OctoPrinter::parse_job_state_progress(JsonDocument& in)
 {
     float completion = in["progress"]["completion"];
@@ -0,0 +1,291 @@
+#include "ota_download.h"
+#include "task_layout.h"
+#include "../conf/global_config.h"
+#include <HTTPClient.h>
+#include <Update.h>
+#include <mbedtls/sha256.h>
+
+enum AttemptResult
+{
+    AttemptDone = 0,
+    AttemptRetry = 1,
+    AttemptFatal = 2,
+};
+
+// Status is read from the render task, everything else is only touched by the download task
+static portMUX_TYPE status_lock = portMUX_INITIALIZER_UNLOCKED;
+static OtaDownloadStatus status = {OtaDownloadIdle, 0, 0, 0};
+
+static char download_url[256];
+static char expected_sha256[65];
+static unsigned int expected_size;
+static unsigned int downloaded;
+static unsigned int total_size;
+static bool update_started;
+static mbedtls_sha256_context sha_context;
+static unsigned char buffer[2048];
+
+static void set_status(OtaDownloadState state)
+{
+    portENTER_CRITICAL(&status_lock);
+    status.state = state;
+    status.downloaded = downloaded;
+    status.total = total_size;
+    portEXIT_CRITICAL(&status_lock);
+}
+
+static void discard_image()
+{
+    if (update_started)
+    {
+        Update.abort();
+        mbedtls_sha256_free(&sha_context);
+    }
+
+    update_started = false;
+    downloaded = 0;
+    total_size = 0;
+}
+
+static bool begin_image(HTTPClient& http)
+{
+    total_size = expected_size;
+    int length = http.getSize();
+
+    if (total_size == 0 && length > 0)
+    {
+        total_size = length;
+    }
+
+    if (total_size == 0)
+    {
+        LOG_LN("OTA: Image size unknown");
+        return false;
+    }
+
+    if (!Update.begin(total_size))
+    {
+        LOG_F(("OTA: Cannot start update: %s\n", Update.errorString()))
+        return false;
+    }
+
+    mbedtls_sha256_init(&sha_context);
+    mbedtls_sha256_starts_ret(&sha_context, 0);
+    update_started = true;
+    return true;
+}
+
+static AttemptResult download_attempt()
+{
+    HTTPClient http;
+    http.setConnectTimeout(OTA_DOWNLOAD_READ_TIMEOUT_MS);
+    http.setTimeout(OTA_DOWNLOAD_READ_TIMEOUT_MS);
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+
+    if (!http.begin(download_url))
+    {
+        return AttemptFatal;
+    }
+
+    const char* collect_headers[] = {"Content-Range"};
+    http.collectHeaders(collect_headers, 1);
+
+    if (downloaded > 0)
+    {
+        char range[24];
+        sprintf(range, "bytes=%u-", downloaded);
+        http.addHeader("Range", range);
+    }
+
+    int http_code = http.GET();
+
+    if (http_code == HTTP_CODE_OK && downloaded > 0)
+    {
+        LOG_LN("OTA: Server ignored the range request, starting over");
+        discard_image();
+    }
+    else if (http_code == HTTP_CODE_PARTIAL_CONTENT)
+    {
+        unsigned int start = 0;
+
+        if (sscanf(http.header("Content-Range").c_str(), "bytes %u-", &start) != 1 || start != downloaded)
+        {
+            LOG_F(("OTA: Asked for byte %u, got range '%s'\n", downloaded, http.header("Content-Range").c_str()))
+            discard_image();
+            http.end();
+            return AttemptRetry;
+        }
+    }
+    else if (http_code != HTTP_CODE_OK)
+    {
+        LOG_F(("OTA: Download failed: HTTP %d\n", http_code))
+        http.end();
+        // A missing file does not show up by asking again
+        return http_code >= 400 && http_code < 500 ? AttemptFatal : AttemptRetry;
+    }
+
+    if (!update_started && !begin_image(http))
+    {
+        http.end();
+        return AttemptFatal;
+    }
+
+    WiFiClient* stream = http.getStreamPtr();
+    unsigned long last_data = millis();
+
+    while (downloaded < total_size)
+    {
+        int available = stream->available();
+
+        if (available <= 0)
+        {
+            if (!stream->connected() || millis() - last_data > OTA_DOWNLOAD_READ_TIMEOUT_MS)
+            {
+                break;
+            }
+
+            // Waits for data instead of spinning, so the render task keeps its share of the CPU
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        size_t length = min((size_t)available, min(sizeof(buffer), (size_t)(total_size - downloaded)));
+        int read = stream->read(buffer, length);
+
+        if (read <= 0)
+        {
+            continue;
+        }
+
+        mbedtls_sha256_update_ret(&sha_context, buffer, read);
+
+        if (Update.write(buffer, read) != (size_t)read)
+        {
+            LOG_F(("OTA: Flash write failed: %s\n", Update.errorString()))
+            http.end();
+            return AttemptFatal;
+        }
+
+        downloaded += read;
+        last_data = millis();
+        set_status(OtaDownloadRunning);
+    }
+
+    http.end();
+    return downloaded >= total_size ? AttemptDone : AttemptRetry;
+}
+
+static bool verify_image()
+{
+    unsigned char digest[32];
+    char digest_hex[65];
+    mbedtls_sha256_finish_ret(&sha_context, digest);
+    mbedtls_sha256_free(&sha_context);
+    update_started = false;
+
+    for (size_t i = 0; i < sizeof(digest); i++)
+    {
+        sprintf(digest_hex + i * 2, "%02x", digest[i]);
+    }
+
+    if (expected_sha256[0] != '\0' && strcasecmp(digest_hex, expected_sha256) != 0)
+    {
+        LOG_F(("OTA: SHA-256 mismatch, got %s\n", digest_hex))
+        Update.abort();
+        return false;
+    }
+
+    // Also checks the image header and marks the partition as the next boot partition
+    if (!Update.end())
+    {
+        LOG_F(("OTA: Image rejected: %s\n", Update.errorString()))
+        return false;
+    }
+
+    LOG_F(("OTA: Image verified, SHA-256 %s\n", digest_hex))
+    return true;
+}
+
+static void ota_download_task(void * param)
+{
+    unsigned long retry_ms = OTA_DOWNLOAD_RETRY_MIN_MS;
+    int attempts_without_progress = 0;
+
+    while (true)
+    {
+        unsigned int downloaded_before = downloaded;
+
+        portENTER_CRITICAL(&status_lock);
+        status.attempt++;
+        portEXIT_CRITICAL(&status_lock);
+        set_status(OtaDownloadRunning);
+
+        AttemptResult result = download_attempt();
+
+        if (result == AttemptDone)
+        {
+            set_status(verify_image() ? OtaDownloadReady : OtaDownloadFailed);
+            break;
+        }
+
+        if (result == AttemptFatal)
+        {
+            discard_image();
+            set_status(OtaDownloadFailed);
+            break;
+        }
+
+        if (downloaded > downloaded_before)
+        {
+            attempts_without_progress = 0;
+            retry_ms = OTA_DOWNLOAD_RETRY_MIN_MS;
+        }
+        else if (++attempts_without_progress >= OTA_DOWNLOAD_MAX_ATTEMPTS)
+        {
+            LOG_LN("OTA: Giving up");
+            discard_image();
+            set_status(OtaDownloadFailed);
+            break;
+        }
+
+        LOG_F(("OTA: Interrupted at %u/%u bytes, resuming in %lu ms\n", downloaded, total_size, retry_ms))
+        set_status(OtaDownloadRetrying);
+        vTaskDelay(pdMS_TO_TICKS(retry_ms));
+        retry_ms = min(retry_ms * 2, (unsigned long)OTA_DOWNLOAD_RETRY_MAX_MS);
+    }
+
+    vTaskDelete(NULL);
+}
+
+bool ota_download_start(const char* url, const char* sha256, unsigned int size)
+{
+    OtaDownloadState state = ota_download_status().state;
+
+    if (state == OtaDownloadRunning || state == OtaDownloadRetrying || state == OtaDownloadReady)
+    {
+        return false;
+    }
+
+    strncpy(download_url, url, sizeof(download_url) - 1);
+    strncpy(expected_sha256, sha256 == NULL ? "" : sha256, sizeof(expected_sha256) - 1);
+    expected_size = size;
+    downloaded = 0;
+    total_size = 0;
+
+    portENTER_CRITICAL(&status_lock);
+    status.attempt = 0;
+    portEXIT_CRITICAL(&status_lock);
+    set_status(OtaDownloadRunning);
+
+    LOG_F(("OTA: Downloading %s\n", download_url))
+    xTaskCreatePinnedToCore(ota_download_task, "ota_download", TASK_OTA_STACK, NULL, TASK_OTA_PRIORITY, NULL, TASK_OTA_CORE);
+    return true;
+}
+
+OtaDownloadStatus ota_download_status()
+{
+    portENTER_CRITICAL(&status_lock);
+    OtaDownloadStatus copy = status;
+    portEXIT_CRITICAL(&status_lock);
+    return copy;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+/*
+ * Downloads a firmware image into the inactive OTA partition from a background task, the UI stays usable meanwhile.
+ * A dropped connection is resumed with an HTTP Range request from the last written byte.
+ * The image is hashed while it is written and only marked bootable when it matches the expected SHA-256.
+ */
+
+#define OTA_DOWNLOAD_MAX_ATTEMPTS 8
+#define OTA_DOWNLOAD_RETRY_MIN_MS 2000
+#define OTA_DOWNLOAD_RETRY_MAX_MS 30000
+#define OTA_DOWNLOAD_READ_TIMEOUT_MS 10000
+
+enum OtaDownloadState
+{
+    OtaDownloadIdle = 0,
+    OtaDownloadRunning = 1,
+    OtaDownloadRetrying = 2,
+    // Verified and set as boot partition, the next restart runs it
+    OtaDownloadReady = 3,
+    OtaDownloadFailed = 4,
+};
+
+typedef struct
+{
+    OtaDownloadState state;
+    unsigned int downloaded;
+    unsigned int total;
+    unsigned char attempt;
+} OtaDownloadStatus;
+
+// sha256 is the lowercase or uppercase hex digest, NULL or empty to rely on the image check of the update partition only.
+// size may be 0 when unknown. Returns false when a download is already running or done
+bool ota_download_start(const char* url, const char* sha256, unsigned int size);
+OtaDownloadStatus ota_download_status();
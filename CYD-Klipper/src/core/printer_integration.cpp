@@ -1,15 +1,50 @@
 #include "printer_integration.hpp"
 #include "lv_setup.h"
 #include "screen_driver.h"
+#include "temperature_history.h"
+#include "boot_timing.h"
+#include "data_setup.h"
 #include <HardwareSerial.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 
 static char blank[] = { '\0' };
 static unsigned char current_printer_index = 0;
-static unsigned char last_announced_printer_index = 0;
 static unsigned char total_printers;
 static BasePrinter** registered_printers;
 static PrinterDataMinimal* minimal_data_copy;
-static PrinterData* printer_data_copy;
+// Latest announced data of every printer, on the LVGL side. Owns the strings once they are announced
+static PrinterData printer_snapshots[PRINTER_CONFIG_COUNT];
+
+static int index_of_printer(BasePrinter* printer)
+{
+    for (int i = 0; i < total_printers; i++)
+    {
+        if (registered_printers[i] == printer)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void free_string(char* string)
+{
+    if (string != NULL && string != blank)
+    {
+        free(string);
+    }
+}
+
+// A printer replaces its strings without freeing them, the old value is freed once the snapshot moves on
+static void free_replaced_string(char* old_string, char* new_string)
+{
+    if (old_string != new_string)
+    {
+        free_string(old_string);
+    }
+}
 
 BasePrinter::BasePrinter(unsigned char index)
 {
@@ -19,76 +54,191 @@ BasePrinter::BasePrinter(unsigned char index)
     // TODO: Fetch printer config and global config
 }
 
-PrinterData* BasePrinter::AnnouncePrinterData()
+BasePrinter::~BasePrinter()
+{
+    // Strings that made it into the snapshot are freed by release_printers
+    int index = index_of_printer(this);
+    PrinterData* snapshot = index >= 0 ? &printer_snapshots[index] : NULL;
+
+    if (snapshot == NULL || printer_data.state_message != snapshot->state_message)
+    {
+        free(printer_data.state_message);
+    }
+
+    if (snapshot == NULL || printer_data.print_filename != snapshot->print_filename)
+    {
+        free(printer_data.print_filename);
+    }
+
+    if (snapshot == NULL || printer_data.popup_message != snapshot->popup_message)
+    {
+        free(printer_data.popup_message);
+    }
+}
+
+enum PrinterUpdateType
+{
+    PrinterUpdateData,
+    PrinterUpdatePowerDevices,
+};
+
+// Snapshots are handed from the data task to the LVGL loop by value, in the order they were made
+typedef struct
+{
+    PrinterUpdateType type;
+    unsigned char printer_index;
+    union
+    {
+        PrinterData data;
+        unsigned int power_devices;
+    };
+} PrinterUpdate;
+
+#define PRINTER_UPDATE_QUEUE_LENGTH 4
+
+static QueueHandle_t printer_update_queue;
+
+static void post_printer_update(PrinterUpdate* update)
+{
+    // Never drop a snapshot: the strings in it are freed once the next one replaces it.
+    // Only blocks when the LVGL loop is stalled, the request lock is never held here
+    xQueueSend(printer_update_queue, update, portMAX_DELAY);
+}
+
+// Called from the network and the prefetch task, so the update is built on the caller's stack
+void BasePrinter::AnnouncePrinterData()
+{
+    PrinterUpdate update;
+    update.type = PrinterUpdateData;
+    update.printer_index = max(index_of_printer(this), 0);
+    memcpy(&update.data, &printer_data, sizeof(PrinterData));
+    post_printer_update(&update);
+}
+
+static void apply_printer_data(PrinterUpdate* update)
 {
-    char* old_state_message = printer_data_copy->state_message;
-    char* old_print_filename = printer_data_copy->print_filename;
-    char* old_popup_message = printer_data_copy->popup_message;
-    PrinterState old_state = printer_data_copy->state;
-    bool no_free = current_printer_index != last_announced_printer_index;
+    PrinterData* snapshot = &printer_snapshots[update->printer_index];
+    char* old_state_message = snapshot->state_message;
+    char* old_print_filename = snapshot->print_filename;
+    char* old_popup_message = snapshot->popup_message;
+    PrinterState old_state = snapshot->state;
 
-    last_announced_printer_index = current_printer_index;
-    memcpy(printer_data_copy, &printer_data, sizeof(PrinterData));
+    memcpy(snapshot, &update->data, sizeof(PrinterData));
 
-    if (printer_data_copy->state_message == NULL)
+    if (snapshot->state_message == NULL)
     {
-        printer_data_copy->state_message = blank;
+        snapshot->state_message = blank;
     }
 
-    if (printer_data_copy->print_filename == NULL)
+    if (snapshot->print_filename == NULL)
     {
-        printer_data_copy->print_filename = blank;
+        snapshot->print_filename = blank;
     }
 
-    if (printer_data_copy->popup_message == NULL)
+    if (snapshot->popup_message == NULL)
     {
-        printer_data_copy->popup_message = blank;
+        snapshot->popup_message = blank;
     }
-    
-    if (old_state_message != printer_data_copy->state_message && old_state_message != NULL && old_state_message != blank && !no_free)
+
+    free_replaced_string(old_state_message, snapshot->state_message);
+    free_replaced_string(old_print_filename, snapshot->print_filename);
+    free_replaced_string(old_popup_message, snapshot->popup_message);
+
+    // The minimal data of every printer follows its latest snapshot
+    PrinterDataMinimal* minimal = &minimal_data_copy[update->printer_index];
+    bool minimal_changed = !minimal->success || minimal->state != snapshot->state;
+    minimal->state = snapshot->state;
+    minimal->print_progress = snapshot->print_progress;
+    minimal->success = true;
+
+    lv_msg_send(DATA_PRINTER_FLEET, snapshot);
+    temperature_history_record(update->printer_index, snapshot);
+
+    if (minimal_changed)
     {
-        LOG_F(("Freeing state message '%s' (%x)\n", old_state_message, old_state_message));
-        free(old_state_message);
+        lv_msg_send(DATA_PRINTER_MINIMAL, get_current_printer());
     }
 
-    if (old_print_filename != printer_data_copy->print_filename && old_print_filename != NULL && old_print_filename != blank && !no_free)
+    // Printers in the background are only kept up to date, they are shown when switched to
+    if (update->printer_index != current_printer_index)
     {
-        LOG_F(("Freeing print filename '%s' (%x)\n", old_print_filename, old_print_filename));
-        free(old_print_filename);
+        return;
     }
 
-    if (old_state != printer_data_copy->state)
+    if (old_state != snapshot->state)
     {
         lv_msg_send(DATA_PRINTER_STATE, get_current_printer());
     }
 
-    if (old_popup_message != printer_data_copy->popup_message)
+    if (snapshot->state != PrinterStateOffline)
     {
-        if (old_popup_message != NULL && old_popup_message != blank && !no_free)
-        {
-            LOG_F(("Freeing popup message '%s' (%x)\n", old_popup_message, old_popup_message));
-            free(old_popup_message);
-        }
+        boot_mark(BootStagePrinterData);
+    }
 
-        if (printer_data_copy->popup_message != NULL && printer_data_copy->popup_message != blank)
-        {
-            lv_msg_send(DATA_PRINTER_POPUP, get_current_printer());
-        }
+    if (old_popup_message != snapshot->popup_message && snapshot->popup_message != blank)
+    {
+        lv_msg_send(DATA_PRINTER_POPUP, get_current_printer());
     }
 
     lv_msg_send(DATA_PRINTER_DATA, get_current_printer());
-    return printer_data_copy;
+}
+
+static void reset_snapshots()
+{
+    memset(printer_snapshots, 0, sizeof(printer_snapshots));
+
+    // The UI is built before the first snapshot arrives
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++)
+    {
+        printer_snapshots[i].state_message = blank;
+        printer_snapshots[i].print_filename = blank;
+        printer_snapshots[i].popup_message = blank;
+    }
 }
 
 void initialize_printers(BasePrinter** printers, unsigned char total)
 {
     LOG_F(("Initializing %d printers\n", total))
-    printer_data_copy = (PrinterData*)malloc(sizeof(PrinterData));
+
+    if (printer_update_queue == NULL)
+    {
+        printer_update_queue = xQueueCreate(PRINTER_UPDATE_QUEUE_LENGTH, sizeof(PrinterUpdate));
+    }
+    else
+    {
+        free(minimal_data_copy);
+        temperature_history_reset();
+    }
+
     minimal_data_copy = (PrinterDataMinimal*)malloc(sizeof(PrinterDataMinimal) *  total);
-    memset(printer_data_copy, 0, sizeof(PrinterData));
     memset(minimal_data_copy, 0, sizeof(PrinterDataMinimal) *  total);
+    reset_snapshots();
     registered_printers = printers;
     total_printers = total;
+    current_printer_index = 0;
+}
+
+void release_printers()
+{
+    LOG_F(("Releasing %d printers\n", total_printers))
+
+    for (int i = 0; i < total_printers; i++)
+    {
+        registered_printers[i]->disconnect();
+        delete registered_printers[i];
+    }
+
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++)
+    {
+        free_string(printer_snapshots[i].state_message);
+        free_string(printer_snapshots[i].print_filename);
+        free_string(printer_snapshots[i].popup_message);
+    }
+
+    free(registered_printers);
+    registered_printers = NULL;
+    total_printers = 0;
+    reset_snapshots();
 }
 
 BasePrinter* get_current_printer()
@@ -113,7 +263,12 @@ int get_current_printer_index()
 
 PrinterData* get_current_printer_data()
 {
-    return printer_data_copy;
+    return &printer_snapshots[current_printer_index];
+}
+
+PrinterData* get_printer_data(int idx)
+{
+    return &printer_snapshots[idx];
 }
 
 unsigned int get_printer_count()
@@ -121,10 +276,42 @@ unsigned int get_printer_count()
     return total_printers;
 }
 
-void announce_printer_data_minimal(PrinterDataMinimal* printer_data)
+void announce_printer_power_devices(int idx, unsigned int count)
 {
-    memcpy(minimal_data_copy, printer_data, sizeof(PrinterDataMinimal) * total_printers);
-    lv_msg_send(DATA_PRINTER_MINIMAL, get_current_printer());
+    PrinterUpdate update;
+    update.type = PrinterUpdatePowerDevices;
+    update.printer_index = idx;
+    update.power_devices = count;
+    post_printer_update(&update);
+}
+
+void wait_for_printer_updates(unsigned int wait_ms)
+{
+    static PrinterUpdate update;
+    xQueuePeek(printer_update_queue, &update, pdMS_TO_TICKS(wait_ms));
+}
+
+void apply_printer_updates()
+{
+    static PrinterUpdate update;
+
+    while (xQueueReceive(printer_update_queue, &update, 0) == pdTRUE)
+    {
+
+        switch (update.type)
+        {
+            case PrinterUpdateData:
+                apply_printer_data(&update);
+                break;
+            case PrinterUpdatePowerDevices:
+                if (minimal_data_copy[update.printer_index].power_devices != update.power_devices)
+                {
+                    minimal_data_copy[update.printer_index].power_devices = update.power_devices;
+                    lv_msg_send(DATA_PRINTER_MINIMAL, get_current_printer());
+                }
+                break;
+        }
+    }
 }
 
 PrinterDataMinimal* get_printer_data_minimal(int idx)
@@ -134,8 +321,19 @@ PrinterDataMinimal* get_printer_data_minimal(int idx)
 
 void set_current_printer(int idx)
 {
+    bool changed = current_printer_index != idx;
     current_printer_index = idx;
     global_config_set_printer(idx);
     set_color_scheme();
     set_invert_display();
+
+    if (!changed)
+    {
+        return;
+    }
+
+    // The snapshot and temperature history kept up in the background are shown right away, the fast poll picks up the new printer immediately
+    lv_msg_send(DATA_PRINTER_STATE, get_current_printer());
+    lv_msg_send(DATA_PRINTER_DATA, get_current_printer());
+    data_poll_now();
 }
\ No newline at end of file
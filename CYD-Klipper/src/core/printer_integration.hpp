@@ -123,6 +123,8 @@ typedef struct {
     char** available_files;
     unsigned int count;
     bool success;
+    // The names belong to the printer, only the array is freed
+    bool names_borrowed;
 } Files;
 
 typedef struct {
@@ -162,6 +164,7 @@ class BasePrinter
         virtual bool execute_feature(PrinterFeatures feature) = 0;
         virtual bool connect() = 0;
         virtual bool fetch() = 0;
+        // Called with the request lock held, from a different task than fetch
         virtual PrinterDataMinimal fetch_min() = 0;
         virtual void disconnect() = 0;
         // Free macros externally when done
@@ -172,16 +175,24 @@ class BasePrinter
         virtual PowerDevices get_power_devices() = 0;
         virtual int get_power_devices_count() = 0;
         virtual bool set_power_device_state(const char* device_name, bool state) = 0;
-        // Free files externally when done
+        // Free files externally when done. Borrowed names stay valid until the next get_files of this printer,
+        // or until it is deleted, so free the previous list before asking for a new one
         virtual Files get_files() = 0;
+        // The files panel is gone, the file list no longer needs to be kept current.
+        // Called from the LVGL task without the request lock
+        virtual void stop_watching_files() {}
         virtual bool start_file(const char* filename) = 0;
         // Free thumbnail externally when done
         virtual Thumbnail get_32_32_png_image_thumbnail(const char* gcode_filename) = 0;
         virtual bool set_target_temperature(PrinterTemperatureDevice device, unsigned int temperature) = 0;
 
         BasePrinter(unsigned char index);
-        PrinterData* AnnouncePrinterData();
+        // Frees the strings in printer_data, disconnect first
+        virtual ~BasePrinter();
+        // Queues a snapshot of printer_data, applied by apply_printer_updates on the LVGL loop
+        void AnnouncePrinterData();
         bool supports_feature(PrinterFeatures feature);
+        unsigned char get_config_index() { return config_index; }
 };
 
 #define DATA_PRINTER_STATE 1
@@ -189,13 +200,26 @@ class BasePrinter
 #define DATA_PRINTER_TEMP_PRESET 3
 #define DATA_PRINTER_MINIMAL 4
 #define DATA_PRINTER_POPUP 5
+// Sent for every applied snapshot of any printer, the payload is the PrinterData of get_printer_data
+#define DATA_PRINTER_FLEET 6
 
 BasePrinter* get_current_printer();
 BasePrinter* get_printer(int idx);
+// Also used to swap in a rebuilt set of printers, after release_printers
 void initialize_printers(BasePrinter** printers, unsigned char total);
+// Disconnects and deletes all printers. The polling tasks must be paused and their updates applied
+void release_printers();
 PrinterData* get_current_printer_data();
+// Latest data of any printer, kept current in the background while multi printer mode is on.
+// Only the LVGL loop may read more than the state
+PrinterData* get_printer_data(int idx);
 unsigned int get_printer_count();
-void announce_printer_data_minimal(PrinterDataMinimal* printer_data);
+// Power devices are counted by the fleet poller, state and progress follow the printer data
+void announce_printer_power_devices(int idx, unsigned int count);
+// Sleeps until the data task queues a snapshot, or wait_ms passed
+void wait_for_printer_updates(unsigned int wait_ms);
+// Applies the snapshots queued by the data task, call from the LVGL loop only
+void apply_printer_updates();
 PrinterDataMinimal* get_printer_data_minimal(int idx);
 int get_current_printer_index();
 void set_current_printer(int idx);
\ No newline at end of file
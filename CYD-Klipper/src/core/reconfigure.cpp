@@ -0,0 +1,168 @@
+#include "reconfigure.h"
+#include "data_setup.h"
+#include "lv_setup.h"
+#include "screen_driver.h"
+#include "host_resolver.h"
+#include "printer_integration.hpp"
+#include "../conf/global_config.h"
+#include "../ui/ip_setup.h"
+#include "../ui/wifi_setup.h"
+#include "../ui/nav_buttons.h"
+#include "lvgl.h"
+#include <WiFi.h>
+
+typedef struct
+{
+    unsigned int count;
+    unsigned long requested_at;
+    // Time spent on setup screens waiting for the user, left out of the time to ready
+    unsigned long interactive_ms;
+    unsigned long last_ms;
+    unsigned long max_ms;
+    bool waiting;
+} ReconfigureTiming;
+
+static const char* class_names[ReconfigureCount] = {"display", "printers", "wifi"};
+static unsigned char pending = 0;
+static ReconfigureTiming timings[ReconfigureCount];
+
+static void start_timing(ReconfigureClass what, unsigned long requested_at)
+{
+    timings[what].requested_at = requested_at;
+    timings[what].interactive_ms = 0;
+    timings[what].waiting = true;
+}
+
+static void finish_timing(ReconfigureClass what)
+{
+    ReconfigureTiming* timing = &timings[what];
+    timing->waiting = false;
+    timing->count++;
+    timing->last_ms = millis() - timing->requested_at - timing->interactive_ms;
+    timing->max_ms = max(timing->max_ms, timing->last_ms);
+    LOG_F(("Reconfigure: %s ready after %lu ms\n", class_names[what], timing->last_ms))
+}
+
+void reconfigure_request(ReconfigureClass what)
+{
+    if (!(pending & BIT(what)))
+    {
+        pending |= BIT(what);
+        start_timing(what, millis());
+    }
+
+    LOG_F(("Reconfigure: %s requested\n", class_names[what]))
+}
+
+// The screen was cleaned or rotated, every panel is built again for the current printer state
+static void rebuild_ui()
+{
+    nav_buttons_invalidate();
+    lv_msg_send(DATA_PRINTER_STATE, get_current_printer());
+    lv_refr_now(NULL);
+}
+
+// Shows the printer setup screen when needed and swaps in new printers, polling must be paused
+static void rebuild_printers()
+{
+    if (!global_config.printer_config[global_config.printer_index].setup_complete)
+    {
+        unsigned long start = millis();
+        ip_init();
+        timings[ReconfigurePrinters].interactive_ms += millis() - start;
+    }
+
+    data_recreate_printers();
+}
+
+static void reconfigure_display()
+{
+    screen_apply_rotation();
+
+    unsigned long start = millis();
+    lv_calibrate_if_needed();
+    timings[ReconfigureDisplay].interactive_ms += millis() - start;
+
+    rebuild_ui();
+    finish_timing(ReconfigureDisplay);
+}
+
+static void reconfigure_printers()
+{
+    data_pause();
+    rebuild_printers();
+    data_resume();
+    rebuild_ui();
+}
+
+static void reconfigure_wifi()
+{
+    bool interactive = !global_config.wifi_configured;
+    unsigned long start = millis();
+
+    data_pause();
+    // Blocks on the connecting screen, or on the network list when WiFi is no longer configured
+    wifi_init();
+
+    if (interactive)
+    {
+        timings[ReconfigureWifi].interactive_ms += millis() - start;
+    }
+
+    finish_timing(ReconfigureWifi);
+    host_resolver_init();
+
+    // Printers count from the same request, they are only usable once the network is
+    start_timing(ReconfigurePrinters, timings[ReconfigureWifi].requested_at);
+    timings[ReconfigurePrinters].interactive_ms = timings[ReconfigureWifi].interactive_ms;
+    rebuild_printers();
+    data_resume();
+    rebuild_ui();
+}
+
+void reconfigure_loop()
+{
+    if (pending & BIT(ReconfigureWifi))
+    {
+        pending &= ~(BIT(ReconfigureWifi) | BIT(ReconfigurePrinters));
+        reconfigure_wifi();
+    }
+    else if (pending & BIT(ReconfigurePrinters))
+    {
+        pending &= ~BIT(ReconfigurePrinters);
+        reconfigure_printers();
+    }
+
+    if (pending & BIT(ReconfigureDisplay))
+    {
+        pending &= ~BIT(ReconfigureDisplay);
+        reconfigure_display();
+    }
+
+    // New printers are ready once the first data of the current one is in
+    if (timings[ReconfigurePrinters].waiting && (get_printer_count() == 0 || get_current_printer_data()->state != PrinterStateOffline))
+    {
+        finish_timing(ReconfigurePrinters);
+    }
+}
+
+void reconfigure_print_timings()
+{
+    for (int i = 0; i < ReconfigureCount; i++)
+    {
+        ReconfigureTiming* timing = &timings[i];
+
+        if (timing->waiting)
+        {
+            Serial.printf("Reconfigure %-8s waiting for %lu ms\n", class_names[i], millis() - timing->requested_at - timing->interactive_ms);
+        }
+        else if (timing->count == 0)
+        {
+            Serial.printf("Reconfigure %-8s not done since boot\n", class_names[i]);
+        }
+        else
+        {
+            Serial.printf("Reconfigure %-8s %u times, last ready after %lu ms, slowest %lu ms\n", class_names[i], timing->count, timing->last_ms, timing->max_ms);
+        }
+    }
+}
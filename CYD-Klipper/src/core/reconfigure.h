@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+ * Applies settings changes at runtime instead of restarting. A change is requested from the LVGL task,
+ * reconfigure_loop() then tears down and rebuilds only the affected part, outside of any LVGL callback.
+ * How long each kind of change takes until the device is usable again is kept for the 'boot' serial command.
+ */
+
+enum ReconfigureClass
+{
+    // Screen rotation and touch calibration
+    ReconfigureDisplay = 0,
+    // Printers added, removed or pointed elsewhere. Shows the printer setup screen when the current one is not set up
+    ReconfigurePrinters = 1,
+    // WiFi credentials or addressing. Rebuilds the printers as well
+    ReconfigureWifi = 2,
+    ReconfigureCount = 3,
+};
+
+void reconfigure_request(ReconfigureClass what);
+// Call from the LVGL loop only
+void reconfigure_loop();
+void reconfigure_print_timings();
@@ -0,0 +1,321 @@
+#include "request_metrics.h"
+#include <HardwareSerial.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+#define REQUEST_METRICS_BUCKETS 10
+
+// Upper bounds in ms, the last bucket holds everything slower
+static const unsigned short bucket_bounds_ms[REQUEST_METRICS_BUCKETS - 1] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500};
+static const char* phase_names[RequestPhaseCount] = {"connect", "first byte", "transfer", "parse"};
+
+typedef struct
+{
+    char endpoint[REQUEST_METRICS_ENDPOINT_LENGTH];
+    unsigned int count;
+    unsigned int failures;
+    unsigned long long bytes;
+    unsigned int phase_count[RequestPhaseCount];
+    unsigned long long phase_total_us[RequestPhaseCount];
+    unsigned long phase_max_us[RequestPhaseCount];
+    // 32 bit, a 16 bit bucket fills up after a day of polling
+    unsigned int histogram[RequestPhaseCount][REQUEST_METRICS_BUCKETS];
+} EndpointMetrics;
+
+// Requests come in from the network, prefetch and render tasks
+static portMUX_TYPE metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+static EndpointMetrics metrics[REQUEST_METRICS_MAX_ENDPOINTS];
+static unsigned long long metrics_reset_at_us;
+
+static size_t endpoint_name_length(const char* endpoint)
+{
+    const char* query = strchr(endpoint, '?');
+    size_t length = query == NULL ? strlen(endpoint) : query - endpoint;
+    return length < REQUEST_METRICS_ENDPOINT_LENGTH - 1 ? length : REQUEST_METRICS_ENDPOINT_LENGTH - 1;
+}
+
+// Must be called with the lock held. Once the registry is full, new endpoints share the last slot
+static EndpointMetrics* find_endpoint(const char* endpoint)
+{
+    size_t length = endpoint_name_length(endpoint);
+
+    for (int i = 0; i < REQUEST_METRICS_MAX_ENDPOINTS; i++)
+    {
+        EndpointMetrics* entry = &metrics[i];
+
+        if (entry->endpoint[0] == '\0')
+        {
+            if (i == REQUEST_METRICS_MAX_ENDPOINTS - 1)
+            {
+                strcpy(entry->endpoint, "(other)");
+            }
+            else
+            {
+                memcpy(entry->endpoint, endpoint, length);
+                entry->endpoint[length] = '\0';
+            }
+
+            return entry;
+        }
+
+        if (strncmp(entry->endpoint, endpoint, length) == 0 && entry->endpoint[length] == '\0')
+        {
+            return entry;
+        }
+    }
+
+    return &metrics[REQUEST_METRICS_MAX_ENDPOINTS - 1];
+}
+
+static int bucket_of(unsigned long duration_us)
+{
+    unsigned long duration_ms = duration_us / 1000;
+
+    for (int i = 0; i < REQUEST_METRICS_BUCKETS - 1; i++)
+    {
+        if (duration_ms < bucket_bounds_ms[i])
+        {
+            return i;
+        }
+    }
+
+    return REQUEST_METRICS_BUCKETS - 1;
+}
+
+void request_timing_start(RequestTiming* timing, const char* endpoint)
+{
+    memset(timing, 0, sizeof(RequestTiming));
+    timing->endpoint = endpoint;
+    timing->mark_us = esp_timer_get_time();
+}
+
+void request_timing_mark(RequestTiming* timing, RequestPhase phase)
+{
+    unsigned long long now = esp_timer_get_time();
+    unsigned long elapsed_us = now - timing->mark_us;
+
+    if (phase != RequestPhaseTransfer && timing->transfer_since_mark_us > 0)
+    {
+        elapsed_us = elapsed_us > timing->transfer_since_mark_us ? elapsed_us - timing->transfer_since_mark_us : 0;
+        timing->phase_us[RequestPhaseTransfer] += timing->transfer_since_mark_us;
+        timing->phases |= 1 << RequestPhaseTransfer;
+    }
+
+    timing->phase_us[phase] += elapsed_us;
+    timing->phases |= 1 << phase;
+    timing->transfer_since_mark_us = 0;
+    timing->mark_us = now;
+}
+
+void request_timing_add_bytes(RequestTiming* timing, unsigned int bytes)
+{
+    timing->bytes += bytes;
+}
+
+void request_timing_finish(RequestTiming* timing, bool success)
+{
+    if (timing->transfer_since_mark_us > 0)
+    {
+        timing->phase_us[RequestPhaseTransfer] += timing->transfer_since_mark_us;
+        timing->phases |= 1 << RequestPhaseTransfer;
+        timing->transfer_since_mark_us = 0;
+    }
+
+    portENTER_CRITICAL(&metrics_lock);
+    EndpointMetrics* entry = find_endpoint(timing->endpoint);
+    entry->count++;
+    entry->bytes += timing->bytes;
+
+    if (!success)
+    {
+        entry->failures++;
+    }
+
+    for (int i = 0; i < RequestPhaseCount; i++)
+    {
+        if (!(timing->phases & (1 << i)))
+        {
+            continue;
+        }
+
+        unsigned long duration_us = timing->phase_us[i];
+        entry->histogram[i][bucket_of(duration_us)]++;
+        entry->phase_count[i]++;
+        entry->phase_total_us[i] += duration_us;
+
+        if (duration_us > entry->phase_max_us[i])
+        {
+            entry->phase_max_us[i] = duration_us;
+        }
+    }
+
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+// Upper bound of the bucket the given percentile falls in, 0 when it falls in the open ended last bucket.
+// Counts against the histogram's own total rather than phase_count
+static unsigned short percentile_bound_ms(const unsigned int* histogram, int percentile)
+{
+    unsigned long long count = 0;
+
+    for (int i = 0; i < REQUEST_METRICS_BUCKETS; i++)
+    {
+        count += histogram[i];
+    }
+
+    unsigned long long target = (count * percentile + 99) / 100;
+    unsigned long long seen = 0;
+
+    for (int i = 0; i < REQUEST_METRICS_BUCKETS - 1; i++)
+    {
+        seen += histogram[i];
+
+        if (seen >= target)
+        {
+            return bucket_bounds_ms[i];
+        }
+    }
+
+    return 0;
+}
+
+void request_metrics_print()
+{
+    Serial.printf("Requests since the last reset (%llu s ago). Buckets (ms):", (esp_timer_get_time() - metrics_reset_at_us) / 1000000);
+
+    for (int i = 0; i < REQUEST_METRICS_BUCKETS - 1; i++)
+    {
+        Serial.printf(" <%u", bucket_bounds_ms[i]);
+    }
+
+    Serial.printf(" >=%u\n", bucket_bounds_ms[REQUEST_METRICS_BUCKETS - 2]);
+
+    for (int i = 0; i < REQUEST_METRICS_MAX_ENDPOINTS; i++)
+    {
+        // Copy out under the lock, printing is far too slow to hold it
+        EndpointMetrics entry;
+        portENTER_CRITICAL(&metrics_lock);
+        memcpy(&entry, &metrics[i], sizeof(EndpointMetrics));
+        portEXIT_CRITICAL(&metrics_lock);
+
+        if (entry.count == 0)
+        {
+            continue;
+        }
+
+        Serial.printf("%s: %u requests, %u failed, %llu bytes/request\n", entry.endpoint, entry.count, entry.failures, entry.bytes / entry.count);
+
+        for (int phase = 0; phase < RequestPhaseCount; phase++)
+        {
+            unsigned int count = entry.phase_count[phase];
+
+            if (count == 0)
+            {
+                continue;
+            }
+
+            unsigned int* histogram = entry.histogram[phase];
+            unsigned short p50 = percentile_bound_ms(histogram, 50);
+            unsigned short p90 = percentile_bound_ms(histogram, 90);
+
+            Serial.printf("  %-10s avg %5llu ms, max %5lu ms, p50 %s%-4u p90 %s%-4u [",
+                phase_names[phase],
+                entry.phase_total_us[phase] / count / 1000,
+                entry.phase_max_us[phase] / 1000,
+                p50 == 0 ? ">=" : "<", p50 == 0 ? bucket_bounds_ms[REQUEST_METRICS_BUCKETS - 2] : p50,
+                p90 == 0 ? ">=" : "<", p90 == 0 ? bucket_bounds_ms[REQUEST_METRICS_BUCKETS - 2] : p90);
+
+            for (int bucket = 0; bucket < REQUEST_METRICS_BUCKETS; bucket++)
+            {
+                Serial.printf(bucket == 0 ? "%u" : " %u", histogram[bucket]);
+            }
+
+            Serial.println("]");
+        }
+    }
+}
+
+void request_metrics_reset()
+{
+    portENTER_CRITICAL(&metrics_lock);
+    memset(metrics, 0, sizeof(metrics));
+    metrics_reset_at_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+MeteredStream::MeteredStream(Stream& source, RequestTiming* timing)
+{
+    this->source = &source;
+    this->timing = timing;
+    buffer_start = 0;
+    buffer_end = 0;
+    setTimeout(source.getTimeout());
+}
+
+// Reads in chunks, so per character reads from the JSON parser do not each pay for a timestamp
+bool MeteredStream::fill()
+{
+    if (buffer_start < buffer_end)
+    {
+        return true;
+    }
+
+    int available = source->available();
+    size_t length = available > (int)sizeof(buffer) ? sizeof(buffer) : (available > 0 ? available : 1);
+
+    unsigned long long started = esp_timer_get_time();
+    size_t read = source->readBytes(buffer, length);
+    timing->transfer_since_mark_us += esp_timer_get_time() - started;
+    timing->bytes += read;
+
+    buffer_start = 0;
+    buffer_end = read;
+    return read > 0;
+}
+
+int MeteredStream::available()
+{
+    return (buffer_end - buffer_start) + source->available();
+}
+
+int MeteredStream::read()
+{
+    if (!fill())
+    {
+        return -1;
+    }
+
+    return (unsigned char)buffer[buffer_start++];
+}
+
+int MeteredStream::peek()
+{
+    if (!fill())
+    {
+        return -1;
+    }
+
+    return (unsigned char)buffer[buffer_start];
+}
+
+size_t MeteredStream::readBytes(char* out, size_t length)
+{
+    size_t copied = 0;
+
+    while (copied < length && fill())
+    {
+        size_t chunk = buffer_end - buffer_start;
+
+        if (chunk > length - copied)
+        {
+            chunk = length - copied;
+        }
+
+        memcpy(out + copied, buffer + buffer_start, chunk);
+        buffer_start += chunk;
+        copied += chunk;
+    }
+
+    return copied;
+}
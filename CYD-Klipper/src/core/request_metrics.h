@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Stream.h>
+
+/*
+ * Per endpoint request metrics, kept in static memory.
+ * Every phase of a request lands in a fixed bucket histogram (see request_metrics.cpp for the bucket bounds).
+ * - connect: opening the socket (and TLS session) for backends that keep a connection open.
+ *   For HTTPClient requests connecting happens inside GET(), so it is part of first byte.
+ * - first byte: sending the request until the response headers are in.
+ * - transfer: time spent waiting on and reading the response body.
+ * - parse: deserializing the response, without the time spent reading it.
+ */
+
+#define REQUEST_METRICS_MAX_ENDPOINTS 20
+#define REQUEST_METRICS_ENDPOINT_LENGTH 32
+
+enum RequestPhase
+{
+    RequestPhaseConnect = 0,
+    RequestPhaseFirstByte = 1,
+    RequestPhaseTransfer = 2,
+    RequestPhaseParse = 3,
+    RequestPhaseCount = 4,
+};
+
+typedef struct
+{
+    const char* endpoint;
+    unsigned long long mark_us;
+    // Transfer time that elapsed since the last mark, taken out of the phase that is closed next
+    unsigned long transfer_since_mark_us;
+    unsigned long phase_us[RequestPhaseCount];
+    unsigned char phases;
+    unsigned int bytes;
+} RequestTiming;
+
+// Starts timing a request. Endpoint names are cut at the first '?', so query strings do not split metrics
+void request_timing_start(RequestTiming* timing, const char* endpoint);
+// Closes the phase running since the start or the previous mark
+void request_timing_mark(RequestTiming* timing, RequestPhase phase);
+void request_timing_add_bytes(RequestTiming* timing, unsigned int bytes);
+// Records the request into the registry. Phases that were never marked are not recorded
+void request_timing_finish(RequestTiming* timing, bool success);
+
+void request_metrics_print();
+void request_metrics_reset();
+
+// Reads from another stream, attributing the time spent reading and the bytes read to a request as transfer
+class MeteredStream : public Stream
+{
+private:
+    Stream* source;
+    RequestTiming* timing;
+    char buffer[64];
+    unsigned char buffer_start;
+    unsigned char buffer_end;
+
+    bool fill();
+
+public:
+    MeteredStream(Stream& source, RequestTiming* timing);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+};
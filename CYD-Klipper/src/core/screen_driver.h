@@ -3,4 +3,6 @@
 
 void screen_setBrightness(unsigned char brightness);
 void screen_setup();
-void set_invert_display();
\ No newline at end of file
+void set_invert_display();
+// Applies global_config.rotate_screen to the running display and touch driver
+void screen_apply_rotation();
\ No newline at end of file
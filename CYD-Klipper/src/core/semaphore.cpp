@@ -1,28 +1,44 @@
 #include "semaphore.h"
+#include "printer_integration.hpp"
 #include <UrlEncode.h>
 #include <esp_task_wdt.h>
 
-SemaphoreHandle_t freezeRenderThreadSemaphore, freezeRequestThreadSemaphore;
+SemaphoreHandle_t freezeRequestThreadSemaphore;
+// One per printer configuration, a printer that is slow to answer only blocks its own requests
+static SemaphoreHandle_t printer_request_semaphores[PRINTER_CONFIG_COUNT];
+// Only touched while holding freezeRequestThreadSemaphore
+static BasePrinter* frozen_printer;
 
 void semaphore_init(){
-    freezeRenderThreadSemaphore = xSemaphoreCreateMutex();
     freezeRequestThreadSemaphore = xSemaphoreCreateMutex();
-    xSemaphoreGive(freezeRenderThreadSemaphore);
     xSemaphoreGive(freezeRequestThreadSemaphore);
+
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++){
+        printer_request_semaphores[i] = xSemaphoreCreateMutex();
+    }
 }
 
-void freeze_request_thread(){
+BasePrinter* freeze_request_thread(){
     xSemaphoreTake(freezeRequestThreadSemaphore, portMAX_DELAY);
+    frozen_printer = get_printer_count() > 0 ? get_current_printer() : NULL;
+    freeze_printer_requests(frozen_printer);
+    return frozen_printer;
 }
 
 void unfreeze_request_thread(){
+    unfreeze_printer_requests(frozen_printer);
+    frozen_printer = NULL;
     xSemaphoreGive(freezeRequestThreadSemaphore);
 }
 
-void freeze_render_thread(){
-    xSemaphoreTake(freezeRenderThreadSemaphore, portMAX_DELAY);
+void freeze_printer_requests(BasePrinter* printer){
+    if (printer != NULL){
+        xSemaphoreTake(printer_request_semaphores[printer->get_config_index()], portMAX_DELAY);
+    }
 }
 
-void unfreeze_render_thread(){
-    xSemaphoreGive(freezeRenderThreadSemaphore);
+void unfreeze_printer_requests(BasePrinter* printer){
+    if (printer != NULL){
+        xSemaphoreGive(printer_request_semaphores[printer->get_config_index()]);
+    }
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 
+class BasePrinter;
+
 void semaphore_init();
 
-void freeze_request_thread();
+// Holds off the requests to the shown printer. Returns that printer, its lock stays taken until
+// unfreeze_request_thread even if another printer is shown meanwhile
+BasePrinter* freeze_request_thread();
 void unfreeze_request_thread();
 
-// Don't use unless you want trouble
-void freeze_render_thread();
-// Don't use unless you want trouble
-void unfreeze_render_thread();
\ No newline at end of file
+// Serialises the requests to one printer without holding up the UI, for printers polled in the background.
+// Never take freeze_request_thread while holding this
+void freeze_printer_requests(BasePrinter* printer);
+void unfreeze_printer_requests(BasePrinter* printer);
\ No newline at end of file
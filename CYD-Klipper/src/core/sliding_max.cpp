@@ -0,0 +1,36 @@
+#include "sliding_max.h"
+
+void sliding_max_init(SlidingMax* max, unsigned short* sample_buffer, short* value_buffer, unsigned short window)
+{
+    max->sample = sample_buffer;
+    max->value = value_buffer;
+    max->window = window;
+    max->head = 0;
+    max->count = 0;
+}
+
+void sliding_max_push(SlidingMax* max, unsigned short sample, short value)
+{
+    while (max->count > 0 && max->value[(max->head + max->count - 1) % max->window] <= value)
+    {
+        max->count--;
+    }
+
+    // Expired samples go first, a strictly decreasing run of a whole window would otherwise not leave room.
+    // The subtraction keeps the age correct when the sample numbers wrap around
+    while (max->count > 0 && (unsigned short)(sample - max->sample[max->head]) >= max->window)
+    {
+        max->head = (max->head + 1) % max->window;
+        max->count--;
+    }
+
+    unsigned short tail = (max->head + max->count) % max->window;
+    max->sample[tail] = sample;
+    max->value[tail] = value;
+    max->count++;
+}
+
+short sliding_max_get(const SlidingMax* max, short empty_value)
+{
+    return max->count > 0 ? max->value[max->head] : empty_value;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+ * Running maximum over the last `window` samples of a series, in constant time per sample.
+ * The deque holds samples with strictly decreasing values, so the front is the maximum and each sample
+ * is added and removed once. The caller provides the buffers, each `window` entries long.
+ * No Arduino or LVGL dependencies, covered by the native tests.
+ */
+
+typedef struct
+{
+    unsigned short* sample;
+    short* value;
+    unsigned short window;
+    unsigned short head;
+    unsigned short count;
+} SlidingMax;
+
+void sliding_max_init(SlidingMax* max, unsigned short* sample_buffer, short* value_buffer, unsigned short window);
+// Sample numbers count up by one per push and may wrap around
+void sliding_max_push(SlidingMax* max, unsigned short sample, short value);
+// Returns empty_value when nothing was pushed yet
+short sliding_max_get(const SlidingMax* max, short empty_value);
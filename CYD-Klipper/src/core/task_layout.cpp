@@ -0,0 +1,132 @@
+#include "task_layout.h"
+#include <HardwareSerial.h>
+#include <esp_timer.h>
+#include <esp_freertos_hooks.h>
+
+// A longer gap between two calls of the idle hook means a task or interrupt ran on the core meanwhile
+#define TASK_IDLE_GAP_US 50
+// The idle hooks keep the idle tasks spinning, so the CPU load is only measured over this window
+#define TASK_LOAD_WINDOW_MS 1000
+
+typedef struct
+{
+    TaskHandle_t handle;
+    unsigned long long busy_us;
+    unsigned long long reported_busy_us;
+} TaskStats;
+
+typedef struct
+{
+    unsigned long long last_idle_us;
+    unsigned long long idle_us;
+} CoreStats;
+
+static TaskStats task_stats[TaskIdCount];
+static CoreStats core_stats[portNUM_PROCESSORS];
+static unsigned long long stats_reported_at_us;
+
+static bool measure_idle(int core)
+{
+    CoreStats* stats = &core_stats[core];
+    unsigned long long now = esp_timer_get_time();
+    unsigned long long gap = now - stats->last_idle_us;
+
+    if (gap < TASK_IDLE_GAP_US)
+    {
+        stats->idle_us += gap;
+    }
+
+    stats->last_idle_us = now;
+    // Keeps the idle task calling instead of waiting for the next interrupt, so every gap is time taken by others
+    return false;
+}
+
+static bool measure_idle_core0()
+{
+    return measure_idle(0);
+}
+
+static bool measure_idle_core1()
+{
+    return measure_idle(1);
+}
+
+void task_register(TaskId id)
+{
+    task_stats[id].handle = xTaskGetCurrentTaskHandle();
+}
+
+void task_add_busy_time(TaskId id, unsigned long busy_us)
+{
+    task_stats[id].busy_us += busy_us;
+}
+
+// Blocks the calling task for the window, the idle tasks only spin while it lasts
+static void print_core_load()
+{
+    unsigned long long start = esp_timer_get_time();
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++)
+    {
+        core_stats[i].last_idle_us = start;
+        core_stats[i].idle_us = 0;
+    }
+
+    esp_register_freertos_idle_hook_for_cpu(measure_idle_core0, 0);
+#if portNUM_PROCESSORS > 1
+    esp_register_freertos_idle_hook_for_cpu(measure_idle_core1, 1);
+#endif
+
+    vTaskDelay(pdMS_TO_TICKS(TASK_LOAD_WINDOW_MS));
+
+    esp_deregister_freertos_idle_hook_for_cpu(measure_idle_core0, 0);
+#if portNUM_PROCESSORS > 1
+    esp_deregister_freertos_idle_hook_for_cpu(measure_idle_core1, 1);
+#endif
+
+    unsigned long long window_us = esp_timer_get_time() - start;
+    Serial.printf("CPU load over %llu ms:", window_us / 1000);
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++)
+    {
+        // The calling task sleeps through the window, the load of its core leaves it out
+        float load = 100.0f - core_stats[i].idle_us * 100.0f / window_us;
+        Serial.printf("  core %d %5.1f%%", i, load < 0 ? 0 : load);
+    }
+
+    Serial.println();
+}
+
+void task_print_stats()
+{
+    print_core_load();
+
+    unsigned long long now = esp_timer_get_time();
+    unsigned long long elapsed_us = now - stats_reported_at_us;
+    stats_reported_at_us = now;
+
+    Serial.println("Busy is the time a task spent on its work, waiting on the network included:");
+
+    for (int i = 0; i < TaskIdCount; i++)
+    {
+        TaskStats* stats = &task_stats[i];
+
+        if (stats->handle == NULL)
+        {
+            continue;
+        }
+
+        unsigned long long busy_us = stats->busy_us;
+        float busy = elapsed_us > 0 ? (busy_us - stats->reported_busy_us) * 100.0f / elapsed_us : 0;
+        stats->reported_busy_us = busy_us;
+
+        BaseType_t core = xTaskGetAffinity(stats->handle);
+
+        Serial.printf("%-16s core %-3s prio %2u  busy %5.1f%%  stack free %u bytes\n",
+            pcTaskGetName(stats->handle),
+            core == tskNO_AFFINITY ? "any" : (core == 0 ? "0" : "1"),
+            uxTaskPriorityGet(stats->handle),
+            busy,
+            uxTaskGetStackHighWaterMark(stats->handle));
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/*
+ * Task layout. Every value can be overridden per board through build flags.
+ * - render: the Arduino loop task. Runs LVGL, touch, the serial console and applies printer updates.
+ *   Its core is ARDUINO_RUNNING_CORE, display flushes complete through DMA from this task.
+ * - network: fetches the current printer and posts snapshots to the render task.
+ * - prefetch: keeps background printer sessions alive and fetches the multi printer overview.
+ * - ota: one-shot tasks. One checks for a firmware update once WiFi is up during boot, another downloads it.
+ * - discovery: one-shot, browses mDNS for printers while the printer setup screen is open.
+ */
+
+#ifndef TASK_RENDER_PRIORITY
+#define TASK_RENDER_PRIORITY 1
+#endif
+
+#ifndef TASK_RENDER_STACK
+#define TASK_RENDER_STACK 8192
+#endif
+
+#ifndef TASK_NETWORK_PRIORITY
+#define TASK_NETWORK_PRIORITY 2
+#endif
+
+#ifndef TASK_NETWORK_STACK
+#define TASK_NETWORK_STACK 5000
+#endif
+
+#ifndef TASK_PREFETCH_PRIORITY
+#define TASK_PREFETCH_PRIORITY 1
+#endif
+
+#ifndef TASK_PREFETCH_STACK
+#define TASK_PREFETCH_STACK 5000
+#endif
+
+// Network tasks share the core of the WiFi stack, so rendering never waits on them
+#ifndef TASK_NETWORK_CORE
+#define TASK_NETWORK_CORE 0
+#endif
+
+#ifndef TASK_PREFETCH_CORE
+#define TASK_PREFETCH_CORE 0
+#endif
+
+#ifndef TASK_OTA_PRIORITY
+#define TASK_OTA_PRIORITY 1
+#endif
+
+// Sized for the TLS handshake
+#ifndef TASK_OTA_STACK
+#define TASK_OTA_STACK 8192
+#endif
+
+#ifndef TASK_OTA_CORE
+#define TASK_OTA_CORE 0
+#endif
+
+#ifndef TASK_DISCOVERY_PRIORITY
+#define TASK_DISCOVERY_PRIORITY 1
+#endif
+
+#ifndef TASK_DISCOVERY_STACK
+#define TASK_DISCOVERY_STACK 4096
+#endif
+
+#ifndef TASK_DISCOVERY_CORE
+#define TASK_DISCOVERY_CORE 0
+#endif
+
+enum TaskId
+{
+    TaskIdRender = 0,
+    TaskIdNetwork = 1,
+    TaskIdPrefetch = 2,
+    TaskIdCount = 3,
+};
+
+// Registers the calling task under the given id
+void task_register(TaskId id);
+// Tasks time their own work, as the FreeRTOS run time stats are disabled in the prebuilt SDK.
+// This is wall time, blocking network calls count as busy
+void task_add_busy_time(TaskId id, unsigned long busy_us);
+// Prints the CPU load per core, measured through the idle hooks over the next second, then
+// the busy time and stack headroom of every registered task since the previous call
+void task_print_stats();
@@ -0,0 +1,162 @@
+#include "temperature_history.h"
+#include <Arduino.h>
+
+typedef struct
+{
+    short actual[TEMPERATURE_HISTORY_POINTS];
+    short target[TEMPERATURE_HISTORY_POINTS];
+} TemperatureHistoryRing;
+
+typedef struct
+{
+    TemperatureHistoryRing heaters[TemperatureHistoryHeaterCount];
+    // The newest sample lives at (count - 1) % TEMPERATURE_HISTORY_POINTS
+    unsigned int count;
+    // Snapshots of the period that is still running get averaged into one sample
+    unsigned long period;
+    int actual_sum[TemperatureHistoryHeaterCount];
+    short last_target[TemperatureHistoryHeaterCount];
+    unsigned short period_samples;
+} TemperatureHistoryTierData;
+
+static const unsigned long tier_period_ms[TemperatureHistoryTierCount] = { 1000, 10000, 60000 };
+static const PrinterTemperatureDeviceIndex heater_device_index[TemperatureHistoryHeaterCount] = {
+    PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1,
+    PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed,
+};
+
+typedef struct
+{
+    TemperatureHistoryTierData tiers[TemperatureHistoryTierCount];
+} TemperatureHistory;
+
+static TemperatureHistory* histories[PRINTER_CONFIG_COUNT];
+
+static short to_tenths(float temperature)
+{
+    float tenths = temperature * 10;
+
+    if (tenths > SHRT_MAX)
+    {
+        return SHRT_MAX;
+    }
+
+    if (tenths < SHRT_MIN)
+    {
+        return SHRT_MIN;
+    }
+
+    return (short)lroundf(tenths);
+}
+
+static void commit_sample(TemperatureHistoryTierData* tier)
+{
+    unsigned int position = tier->count % TEMPERATURE_HISTORY_POINTS;
+
+    for (int i = 0; i < TemperatureHistoryHeaterCount; i++)
+    {
+        tier->heaters[i].actual[position] = tier->actual_sum[i] / tier->period_samples;
+        tier->heaters[i].target[position] = tier->last_target[i];
+    }
+
+    tier->count++;
+}
+
+void temperature_history_record(int printer_index, const PrinterData* printer_data)
+{
+    TemperatureHistory* history = histories[printer_index];
+
+    if (history == NULL)
+    {
+        history = (TemperatureHistory*)malloc(sizeof(TemperatureHistory));
+
+        if (history == NULL)
+        {
+            return;
+        }
+
+        memset(history, 0, sizeof(TemperatureHistory));
+        histories[printer_index] = history;
+    }
+
+    unsigned long now = millis();
+
+    for (int i = 0; i < TemperatureHistoryTierCount; i++)
+    {
+        TemperatureHistoryTierData* tier = &history->tiers[i];
+        unsigned long period = now / tier_period_ms[i];
+
+        if (tier->period_samples > 0 && period != tier->period)
+        {
+            // Periods without any snapshot (slow fetches) repeat the last sample, so time stays linear
+            unsigned long periods = period - tier->period;
+
+            if (periods > TEMPERATURE_HISTORY_POINTS)
+            {
+                periods = TEMPERATURE_HISTORY_POINTS;
+            }
+
+            for (unsigned long j = 0; j < periods; j++)
+            {
+                commit_sample(tier);
+            }
+
+            memset(tier->actual_sum, 0, sizeof(tier->actual_sum));
+            tier->period_samples = 0;
+        }
+
+        tier->period = period;
+        tier->period_samples++;
+
+        for (int j = 0; j < TemperatureHistoryHeaterCount; j++)
+        {
+            tier->actual_sum[j] += to_tenths(printer_data->temperatures[heater_device_index[j]]);
+            tier->last_target[j] = to_tenths(printer_data->target_temperatures[heater_device_index[j]]);
+        }
+    }
+}
+
+void temperature_history_reset()
+{
+    for (int i = 0; i < PRINTER_CONFIG_COUNT; i++)
+    {
+        free(histories[i]);
+        histories[i] = NULL;
+    }
+}
+
+unsigned int temperature_history_sample_count(int printer_index, TemperatureHistoryTier tier)
+{
+    TemperatureHistory* history = histories[printer_index];
+    return history == NULL ? 0 : history->tiers[tier].count;
+}
+
+unsigned int temperature_history_read(int printer_index, TemperatureHistoryHeater heater, TemperatureHistoryTier tier, short* actual, short* target, unsigned int count)
+{
+    TemperatureHistory* history = histories[printer_index];
+
+    if (history == NULL)
+    {
+        return 0;
+    }
+
+    TemperatureHistoryTierData* data = &history->tiers[tier];
+    TemperatureHistoryRing* ring = &data->heaters[heater];
+    unsigned int available = data->count < TEMPERATURE_HISTORY_POINTS ? data->count : TEMPERATURE_HISTORY_POINTS;
+
+    if (count > available)
+    {
+        count = available;
+    }
+
+    unsigned int start = data->count - count;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int position = (start + i) % TEMPERATURE_HISTORY_POINTS;
+        actual[i] = ring->actual[position];
+        target[i] = ring->target[position];
+    }
+
+    return count;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "printer_integration.hpp"
+
+#define TEMPERATURE_HISTORY_POINTS 120
+
+enum TemperatureHistoryHeater
+{
+    TemperatureHistoryHeaterNozzle = 0,
+    TemperatureHistoryHeaterBed = 1,
+    TemperatureHistoryHeaterCount = 2,
+};
+
+// Every tier keeps TEMPERATURE_HISTORY_POINTS samples: 2 minutes, 20 minutes and 2 hours
+enum TemperatureHistoryTier
+{
+    TemperatureHistoryTier1s = 0,
+    TemperatureHistoryTier10s = 1,
+    TemperatureHistoryTier1m = 2,
+    TemperatureHistoryTierCount = 3,
+};
+
+// Every printer keeps its own history, allocated on its first snapshot (about 3KB), so switching printers
+// shows what was recorded while it polled in the background. A printer that was not polled for a while
+// repeats its last known temperatures over the gap, the same as a slow fetch does.
+// Called with every applied snapshot, on the LVGL loop
+void temperature_history_record(int printer_index, const PrinterData* printer_data);
+// Frees the history of every printer, for when the printers are recreated
+void temperature_history_reset();
+// Total amount of samples stored in the tier, only ever goes up until the next reset
+unsigned int temperature_history_sample_count(int printer_index, TemperatureHistoryTier tier);
+// Copies up to count of the newest samples in tenths of a degree, oldest first. Returns the amount copied
+unsigned int temperature_history_read(int printer_index, TemperatureHistoryHeater heater, TemperatureHistoryTier tier, short* actual, short* target, unsigned int count);
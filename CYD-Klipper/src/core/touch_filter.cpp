@@ -0,0 +1,51 @@
+#include "touch_filter.h"
+
+TouchFilterAction touch_filter_update(TouchFilter* filter, bool pressed, bool asleep, unsigned long now_ms)
+{
+    switch (filter->state)
+    {
+        case TouchFilterWakePressed:
+            if (!pressed)
+            {
+                filter->state = TouchFilterWakeDebounce;
+                filter->released_at = now_ms;
+            }
+
+            return TouchFilterActionNone;
+
+        case TouchFilterWakeDebounce:
+            if (now_ms - filter->released_at < TOUCH_WAKE_DEBOUNCE_MS)
+            {
+                return TouchFilterActionNone;
+            }
+
+            filter->state = TouchFilterReleased;
+            // Debounce is over, handle this read as a fresh one
+            return touch_filter_update(filter, pressed, asleep, now_ms);
+
+        case TouchFilterPressed:
+            if (pressed)
+            {
+                return TouchFilterActionPress;
+            }
+
+            filter->state = TouchFilterReleased;
+            return TouchFilterActionNone;
+
+        case TouchFilterReleased:
+        default:
+            if (!pressed)
+            {
+                return TouchFilterActionNone;
+            }
+
+            if (asleep)
+            {
+                filter->state = TouchFilterWakePressed;
+                return TouchFilterActionWake;
+            }
+
+            filter->state = TouchFilterPressed;
+            return TouchFilterActionPress;
+    }
+}
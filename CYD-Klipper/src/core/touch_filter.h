@@ -0,0 +1,33 @@
+#pragma once
+
+// Presses are ignored for this long after the touch that woke up the screen, some screens don't debounce their signal properly
+#define TOUCH_WAKE_DEBOUNCE_MS 300
+
+enum TouchFilterState
+{
+    TouchFilterReleased,
+    TouchFilterPressed,
+    // The press woke up the screen, it is swallowed until the finger lifts
+    TouchFilterWakePressed,
+    // The finger lifted after waking up the screen, waiting out the debounce period
+    TouchFilterWakeDebounce,
+};
+
+enum TouchFilterAction
+{
+    // Report the touch as released
+    TouchFilterActionNone,
+    // Report the touch as released and wake up the screen
+    TouchFilterActionWake,
+    // Pass the press on to LVGL, it keeps the screen awake
+    TouchFilterActionPress,
+};
+
+typedef struct
+{
+    TouchFilterState state;
+    unsigned long released_at;
+} TouchFilter;
+
+// Feeds one raw touch read into the filter. Never blocks, the state carries over to the next read
+TouchFilterAction touch_filter_update(TouchFilter* filter, bool pressed, bool asleep, unsigned long now_ms);
@@ -46,6 +46,9 @@ private:
     String Device = "";
     String Config = "";
     String CVersion = "";
+    String CURL = "";
+    String CSha256 = "";
+    unsigned int CSize = 0;
     bool DowngradesAllowed = false;
 
     int DownloadJson(const char* URL, String& payload)
@@ -134,6 +137,24 @@ public:
         return CVersion;
     }
 
+    /// @brief Return the firmware URL of the matching configuration, as reported by the JSON
+    String GetURL()
+    {
+        return CURL;
+    }
+
+    /// @brief Return the hex SHA-256 of the firmware, empty when the JSON has none
+    String GetSha256()
+    {
+        return CSha256;
+    }
+
+    /// @brief Return the firmware size in bytes, 0 when the JSON has none
+    unsigned int GetSize()
+    {
+        return CSize;
+    }
+
     /// @brief Override the default "Device" id (MAC Address)
     /// @param device A string identifying the particular device (instance) (typically e.g., a MAC address)
     /// @return The current ESP32OTAPull object for chaining
@@ -220,7 +241,12 @@ public:
             {
                 if (CVersion.isEmpty() || CVersion > String(CurrentVersion) ||
                     (DowngradesAllowed && CVersion != String(CurrentVersion)))
+                {
+                    CURL = config["URL"].isNull() ? "" : (const char *)config["URL"];
+                    CSha256 = config["SHA256"].isNull() ? "" : (const char *)config["SHA256"];
+                    CSize = config["Size"] | 0;
                     return Action == DONT_DO_UPDATE ? UPDATE_AVAILABLE : DoOTAUpdate(config["URL"], Action);
+                }
                 foundProfile = true;
             }
         }
@@ -10,32 +10,55 @@
 #include <Esp.h>
 #include "core/lv_setup.h"
 #include "ui/ota_setup.h"
+#include "core/task_layout.h"
+#include "core/boot_timing.h"
+#include "core/host_resolver.h"
+#include "core/reconfigure.h"
+
+SET_LOOP_TASK_STACK_SIZE(TASK_RENDER_STACK);
 
 void setup() {
     Serial.begin(115200);
+    task_register(TaskIdRender);
+    vTaskPrioritySet(NULL, TASK_RENDER_PRIORITY);
     serial_console::greet();
     load_global_config();
     screen_setup();
     lv_setup();
     LOG_LN("Screen init done");
-    
-    wifi_init();
-    ota_init();
+    boot_mark(BootStageScreen);
+
+    // A configured device connects in the background, the UI shows connecting until data comes in
+    if (!wifi_init_async())
+    {
+        wifi_init();
+    }
+
+    host_resolver_init();
     ip_init();
     data_setup();
 
     nav_style_setup();
     main_ui_setup();
+    lv_refr_now(NULL);
+    boot_mark(BootStageFirstFrame);
+
+    ota_init();
 }
 
+static unsigned int lv_idle_ms = 0;
+
 void loop(){
+    // Sleeps while LVGL is idle, the time spent applying updates is counted by data_loop itself
+    data_loop(lv_idle_ms);
+
+    unsigned long start = micros();
     wifi_ok();
-    data_loop();
-    lv_handler();
+    lv_idle_ms = lv_handler();
     serial_console::run();
+    task_add_busy_time(TaskIdRender, micros() - start);
 
-    if (is_ready_for_ota_update())
-    {
-        ota_do_update();
-    }
+    ota_loop();
+    reconfigure_loop();
+    global_config_loop();
 }
\ No newline at end of file
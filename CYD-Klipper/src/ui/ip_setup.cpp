@@ -13,12 +13,31 @@
 #include "../core/screen_driver.h"
 #include "../core/klipper-serial/serial_klipper_printer_integration.hpp"
 #include "../core/octoprint/octoprint_printer_integration.hpp"
+#include "../core/host_resolver.h"
+#include "../core/task_layout.h"
+#include <ESPmDNS.h>
+
+#define DISCOVERY_MAX_PRINTERS 8
 
 void show_ip_entry();
 void choose_printer_type();
 
 lv_obj_t * main_label;
 
+typedef struct {
+    char host[65];
+    unsigned int address;
+    unsigned short port;
+} DiscoveredPrinter;
+
+// Written by the discovery task, read by the UI once the task is done
+static portMUX_TYPE discovery_lock = portMUX_INITIALIZER_UNLOCKED;
+static DiscoveredPrinter discovered_printers[DISCOVERY_MAX_PRINTERS];
+static int discovered_count = 0;
+static const char* discovered_service = NULL;
+static volatile bool discovery_running = false;
+static lv_timer_t * discovery_timer = NULL;
+
 /* Create a custom keyboard to allow hostnames or ip addresses (a-z, 0 - 9, and -) */
 static const char * kb_map[] = {
     "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", LV_SYMBOL_BACKSPACE, "\n",
@@ -118,6 +137,158 @@ static void show_switch_printer_screen(lv_event_t * e){
     switch_printer_init();
 }
 
+// Moonraker (with [zeroconf] enabled) and OctoPrint announce themselves through DNS-SD
+static void discovery_task(void * param)
+{
+    const char* service = (const char*)param;
+    DiscoveredPrinter found[DISCOVERY_MAX_PRINTERS] = {0};
+    int found_count = 0;
+    int count = MDNS.queryService(service, "tcp");
+
+    for (int i = 0; i < count && found_count < DISCOVERY_MAX_PRINTERS; i++)
+    {
+        DiscoveredPrinter* printer = &found[found_count++];
+        String hostname = MDNS.hostname(i);
+        printer->address = MDNS.IP(i);
+        printer->port = MDNS.port(i);
+
+        // A .local name keeps working when the printer gets a new lease, the address is seeded into the resolver cache
+        if (hostname.length() > 0 && hostname.length() < sizeof(printer->host) - 6)
+        {
+            sprintf(printer->host, "%s.local", hostname.c_str());
+        }
+        else
+        {
+            strcpy(printer->host, IPAddress(printer->address).toString().c_str());
+        }
+    }
+
+    LOG_F(("Discovered %d printer(s) announcing _%s._tcp\n", found_count, service))
+
+    portENTER_CRITICAL(&discovery_lock);
+    memcpy(discovered_printers, found, sizeof(found));
+    discovered_count = found_count;
+    discovered_service = service;
+    portEXIT_CRITICAL(&discovery_lock);
+
+    discovery_running = false;
+    vTaskDelete(NULL);
+}
+
+static void start_discovery(const char* service)
+{
+    if (discovery_running)
+    {
+        return;
+    }
+
+    discovery_running = true;
+    xTaskCreatePinnedToCore(discovery_task, "discovery", TASK_DISCOVERY_STACK, (void*)service, TASK_DISCOVERY_PRIORITY, NULL, TASK_DISCOVERY_CORE);
+}
+
+static const char* discovery_service_for_current_printer()
+{
+    switch (global_config.printer_config[global_config.printer_index].printer_type)
+    {
+        case PrinterType::PrinterTypeKlipper:
+            return "moonraker";
+        case PrinterType::PrinterTypeOctoprint:
+            return "octoprint";
+        default:
+            return NULL;
+    }
+}
+
+// Results are kept while the printer type does not change, so going back and forth does not browse again
+static void discovery_timer_update(lv_timer_t * timer)
+{
+    lv_obj_t * label = (lv_obj_t *)timer->user_data;
+    const char* service = discovery_service_for_current_printer();
+
+    if (!discovery_running && discovered_service != service)
+    {
+        start_discovery(service);
+    }
+
+    if (discovery_running)
+    {
+        lv_label_set_text(label, LV_SYMBOL_REFRESH);
+    }
+    else
+    {
+        lv_label_set_text_fmt(label, LV_SYMBOL_LIST " %d", discovered_count);
+    }
+}
+
+static void on_discovery_button_delete(lv_event_t * e)
+{
+    if (discovery_timer != NULL)
+    {
+        lv_timer_del(discovery_timer);
+        discovery_timer = NULL;
+    }
+}
+
+static void btn_use_discovered_printer(lv_event_t * e)
+{
+    DiscoveredPrinter * printer = (DiscoveredPrinter*)lv_event_get_user_data(e);
+    PrinterConfiguration * config = &global_config.printer_config[global_config.printer_index];
+
+    strcpy(config->printer_host, printer->host);
+    config->klipper_port = printer->port;
+    config->ip_configured = true;
+    host_resolver_seed(printer->host, IPAddress(printer->address));
+    show_ip_entry();
+}
+
+static void btn_search_again(lv_event_t * e)
+{
+    start_discovery(discovery_service_for_current_printer());
+    lv_obj_del((lv_obj_t *)lv_event_get_user_data(e));
+}
+
+static void show_discovered_printers(lv_event_t * e)
+{
+    if (discovery_running)
+    {
+        return;
+    }
+
+    lv_obj_t * parent = lv_create_empty_panel(lv_scr_act());
+    lv_obj_set_style_bg_opa(parent, LV_OPA_100, 0); 
+    lv_obj_align(parent, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_set_size(parent, CYD_SCREEN_WIDTH_PX, CYD_SCREEN_HEIGHT_PX);
+    lv_layout_flex_column(parent);
+
+    lv_obj_set_size(lv_create_empty_panel(parent), 0, 0);
+
+    auto width = CYD_SCREEN_WIDTH_PX - CYD_SCREEN_GAP_PX * 2;
+
+    lv_obj_t * btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, width, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX);
+    lv_obj_add_event_cb(btn, destroy_event_user_data, LV_EVENT_CLICKED, parent);
+
+    lv_obj_t * label = lv_label_create(btn);
+    lv_label_set_text(label, LV_SYMBOL_CLOSE " Close");
+    lv_obj_center(label);
+
+    btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, width, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX);
+    lv_obj_add_event_cb(btn, btn_search_again, LV_EVENT_CLICKED, parent);
+
+    label = lv_label_create(btn);
+    lv_label_set_text(label, LV_SYMBOL_REFRESH " Search again");
+    lv_obj_center(label);
+
+    for (int i = 0; i < discovered_count; i++)
+    {
+        DiscoveredPrinter * printer = &discovered_printers[i];
+        char comment[32];
+        sprintf(comment, "%s:%d", IPAddress(printer->address).toString().c_str(), printer->port);
+        lv_create_custom_menu_button(printer->host, parent, btn_use_discovered_printer, "Use", printer, comment);
+    }
+}
+
 static void host_update(lv_event_t * e)
 {
     lv_obj_t * ta = lv_event_get_target(e);
@@ -285,6 +456,23 @@ void show_ip_entry()
         lv_obj_center(label);
     }
 
+    const char* discovery_service = discovery_service_for_current_printer();
+
+    if (discovery_service != NULL)
+    {
+        lv_obj_t * button_discovered = lv_btn_create(button_row);
+        lv_obj_set_height(button_discovered, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX / 2);
+        lv_obj_set_flex_grow(button_discovered, 1);
+        lv_obj_add_event_cb(button_discovered, show_discovered_printers, LV_EVENT_CLICKED, NULL);
+        lv_obj_add_event_cb(button_discovered, on_discovery_button_delete, LV_EVENT_DELETE, NULL);
+
+        label = lv_label_create(button_discovered);
+        lv_obj_center(label);
+
+        discovery_timer = lv_timer_create(discovery_timer_update, 250, label);
+        discovery_timer_update(discovery_timer);
+    }
+
     lv_obj_t * ip_row = lv_create_empty_panel(top_root);
     lv_obj_set_size(ip_row, CYD_SCREEN_WIDTH_PX - CYD_SCREEN_GAP_PX * 2, LV_SIZE_CONTENT);
     lv_layout_flex_row(ip_row);
@@ -19,9 +19,9 @@ static void macro_run(lv_event_t * e){
 
 int macros_add_macros_to_panel(lv_obj_t * root_panel, BasePrinter* printer)
 {
-    freeze_request_thread();
+    freeze_printer_requests(printer);
     Macros macros = printer->get_macros();
-    unfreeze_request_thread();
+    unfreeze_printer_requests(printer);
 
     if (!macros.success)
     {
@@ -52,16 +52,16 @@ static void power_device_toggle(lv_event_t * e)
     DoubleStorage* device = (DoubleStorage*)lv_event_get_user_data(e);
     LOG_F(("Power Device: %s, State: %d -> %d\n", device->power_device_name, !checked, checked))
 
-    freeze_request_thread();
+    freeze_printer_requests(device->printer);
     device->printer->set_power_device_state(device->power_device_name, checked);
-    unfreeze_request_thread();
+    unfreeze_printer_requests(device->printer);
 }
 
 int macros_add_power_devices_to_panel(lv_obj_t * root_panel, BasePrinter* printer)
 {
-    freeze_request_thread();
+    freeze_printer_requests(printer);
     PowerDevices devices = printer->get_power_devices();
-    unfreeze_request_thread();
+    unfreeze_printer_requests(printer);
 
     if (!devices.success)
     {
@@ -20,10 +20,23 @@ void check_if_screen_needs_to_be_disabled(){
     }  
 }
 
+// Wakes the screen when a print finishes, pauses or fails, but not for a printer going offline
+static void wake_on_state_change(PrinterState state){
+    static PrinterState last_state = PrinterState::PrinterStateOffline;
+
+    if (state == PrinterState::PrinterStateError
+        || (last_state == PrinterState::PrinterStatePrinting && (state == PrinterState::PrinterStateIdle || state == PrinterState::PrinterStatePaused))){
+        screen_timer_wake();
+    }
+
+    last_state = state;
+}
+
 static void on_state_change(void * s, lv_msg_t * m){
     check_if_screen_needs_to_be_disabled();
     
     PrinterData* printer = get_current_printer_data();
+    wake_on_state_change(printer->state);
 
     if (printer->state == PrinterState::PrinterStateOffline){
         nav_buttons_setup(PANEL_CONNECTING);
@@ -6,13 +6,33 @@
 #include "../conf/global_config.h"
 #include "../core/printer_integration.hpp"
 
+#define NAV_PANEL_COUNT (PANEL_PROGRESS + 1)
+// Panels are kept alive while hidden so switching back is instant
+#define NAV_PANEL_CACHE_SIZE 4
+#define NAV_PANEL_CACHE_MIN_FREE_BYTES (6 * 1024)
+#define NAV_PANEL_FETCHED_MAX_AGE_MS 60000
+
 static lv_style_t nav_button_style;
 static lv_style_t nav_button_text_style;
 
+static lv_obj_t * sidebar = NULL;
+static PrinterState sidebar_state;
+static int sidebar_printer_index;
+static bool sidebar_multi_printer_mode;
+static bool nav_invalid = false;
+static unsigned short invalid_panels = 0;
+
+static lv_obj_t * panel_cache[NAV_PANEL_COUNT] = {0};
+static unsigned long panel_last_used[NAV_PANEL_COUNT] = {0};
+
 static void update_printer_data_z_pos(lv_event_t * e) {
     lv_obj_t * label = lv_event_get_target(e);
     char z_pos_buffer[10];
 
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->position[2], 2))){
+        return;
+    }
+
     sprintf(z_pos_buffer, "Z%.2f", get_current_printer_data()->position[2]);
     lv_label_set_text(label, z_pos_buffer);
 }
@@ -20,6 +40,12 @@ static void update_printer_data_z_pos(lv_event_t * e) {
 static void update_printer_data_temp(lv_event_t * e) {
     lv_obj_t * label = lv_event_get_target(e);
     char temp_buffer[10];
+    uint32_t key = lv_label_key(get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
+    key = lv_label_key(get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed], 0, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
 
     sprintf(temp_buffer, "%.0f/%.0f", get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1], get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
     lv_label_set_text(label, temp_buffer);
@@ -28,6 +54,17 @@ static void update_printer_data_temp(lv_event_t * e) {
 static void update_printer_data_time(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char time_buffer[10];
+    unsigned long time = get_current_printer_data()->remaining_time_s;
+    unsigned long hours = time / 3600;
+    unsigned long minutes = (time % 3600) / 60;
+
+    // Key on exactly what is shown: whole hours from 10h up, floored minutes below
+    uint32_t key = lv_label_key(get_current_printer_data()->state);
+    key = lv_label_key(hours >= 10 ? hours * 60 : time / 60, 0, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
 
     if (get_current_printer_data()->state == PrinterState::PrinterStateIdle){
         lv_label_set_text(label, "Idle");
@@ -39,11 +76,6 @@ static void update_printer_data_time(lv_event_t * e){
         return;
     }
 
-    unsigned long time = get_current_printer_data()->remaining_time_s;
-    unsigned long hours = time / 3600;
-    unsigned long minutes = (time % 3600) / 60;
-    unsigned long seconds = (time % 3600) % 60;
-
     if (hours >= 10){
         sprintf(time_buffer, "%luh", hours);
     } else if (hours >= 1){
@@ -140,11 +172,75 @@ void create_button(const char* icon, const char* name, lv_event_cb_t button_clic
     lv_obj_add_style(label, &nav_button_text_style, 0);
 }
 
-void nav_buttons_setup(PANEL_TYPE active_panel){
+static void on_sidebar_delete(lv_event_t * e){
+    sidebar = NULL;
+}
+
+static void on_panel_delete(lv_event_t * e){
+    int type = (int)(intptr_t)lv_event_get_user_data(e);
+    panel_cache[type] = NULL;
+}
+
+static bool panel_cacheable(PANEL_TYPE type){
+    // Both are cheap to build and only shown for a single printer state
+    return type != PANEL_ERROR && type != PANEL_CONNECTING;
+}
+
+// Panels listing data fetched from the printer are rebuilt when they have not been shown for a while
+static bool panel_stale(PANEL_TYPE type){
+    if (type != PANEL_FILES && type != PANEL_MACROS){
+        return false;
+    }
+
+    return millis() - panel_last_used[type] > NAV_PANEL_FETCHED_MAX_AGE_MS;
+}
+
+static void panel_evict(int type){
+    if (panel_cache[type] != NULL){
+        // The delete event clears the cache slot
+        lv_obj_del(panel_cache[type]);
+    }
+}
+
+// Evicts the least recently used panels until there is room for one more, or until LVGL has enough free memory again
+static void panel_cache_trim(PANEL_TYPE keep){
+    while (true){
+        int count = 0;
+        int oldest = -1;
+
+        for (int i = 0; i < NAV_PANEL_COUNT; i++){
+            if (panel_cache[i] == NULL || i == keep){
+                continue;
+            }
+
+            count++;
+            if (oldest < 0 || panel_last_used[i] < panel_last_used[oldest]){
+                oldest = i;
+            }
+        }
+
+        bool low_memory = false;
+#if LV_MEM_CUSTOM == 0
+        lv_mem_monitor_t mon;
+        lv_mem_monitor(&mon);
+        low_memory = mon.free_size < NAV_PANEL_CACHE_MIN_FREE_BYTES;
+#endif
+
+        if (oldest < 0 || (count < NAV_PANEL_CACHE_SIZE && !low_memory)){
+            return;
+        }
+
+        LOG_F(("Evicting cached panel %d\n", oldest))
+        panel_evict(oldest);
+    }
+}
+
+static void sidebar_setup(){
     lv_obj_clean(lv_scr_act());
     lv_obj_clear_flag(lv_scr_act(), LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t * root_panel = lv_create_empty_panel(lv_scr_act());
+    lv_obj_add_event_cb(root_panel, on_sidebar_delete, LV_EVENT_DELETE, NULL);
 
 #ifdef CYD_SCREEN_VERTICAL
     lv_obj_set_size(root_panel, CYD_SCREEN_WIDTH_PX, CYD_SCREEN_SIDEBAR_SIZE_PX); 
@@ -192,9 +288,18 @@ void nav_buttons_setup(PANEL_TYPE active_panel){
         create_button(LV_SYMBOL_HOME, "Printer", btn_click_printer, update_multi_printer_label, root_panel);
     }
 
+    sidebar = root_panel;
+    sidebar_state = get_current_printer_data()->state;
+    sidebar_printer_index = get_current_printer_index();
+    sidebar_multi_printer_mode = global_config.multi_printer_mode;
+}
+
+static lv_obj_t* panel_create(PANEL_TYPE active_panel){
     lv_obj_t * panel = lv_create_empty_panel(lv_scr_act());
     lv_obj_set_size(panel, CYD_SCREEN_PANEL_WIDTH_PX, CYD_SCREEN_PANEL_HEIGHT_PX);
     lv_obj_align(panel, LV_ALIGN_TOP_RIGHT, 0, 0);
+    // Keep popups that are currently open on top of the new panel
+    lv_obj_move_background(panel);
 
     switch (active_panel){
         case PANEL_FILES:
@@ -229,6 +334,63 @@ void nav_buttons_setup(PANEL_TYPE active_panel){
             break;
     }
 
+    lv_obj_add_event_cb(panel, on_panel_delete, LV_EVENT_DELETE, (void*)active_panel);
+    return panel;
+}
+
+void nav_buttons_invalidate_panel(PANEL_TYPE panel){
+    invalid_panels |= 1 << panel;
+}
+
+void nav_buttons_invalidate(){
+    nav_invalid = true;
+}
+
+void nav_buttons_setup(PANEL_TYPE active_panel){
+    // Settings can change the look and content of every other panel
+    if (active_panel != PANEL_SETTINGS && panel_cache[PANEL_SETTINGS] != NULL && !lv_obj_has_flag(panel_cache[PANEL_SETTINGS], LV_OBJ_FLAG_HIDDEN)){
+        nav_invalid = true;
+    }
+
+    if (nav_invalid 
+        || sidebar == NULL 
+        || sidebar_state != get_current_printer_data()->state
+        || sidebar_printer_index != get_current_printer_index()
+        || sidebar_multi_printer_mode != global_config.multi_printer_mode)
+    {
+        // Cleaning the screen also empties the panel cache through the delete events
+        sidebar_setup();
+        nav_invalid = false;
+        invalid_panels = 0;
+    }
+
+    if ((invalid_panels & (1 << active_panel)) || (panel_cache[active_panel] != NULL && panel_stale(active_panel))){
+        panel_evict(active_panel);
+        invalid_panels &= ~(1 << active_panel);
+    }
+
+    for (int i = 0; i < NAV_PANEL_COUNT; i++){
+        if (panel_cache[i] == NULL || i == active_panel){
+            continue;
+        }
+
+        if (panel_cacheable((PANEL_TYPE)i)){
+            lv_obj_add_flag(panel_cache[i], LV_OBJ_FLAG_HIDDEN);
+        }
+        else {
+            panel_evict(i);
+        }
+    }
+
+    if (panel_cache[active_panel] == NULL){
+        panel_cache_trim(active_panel);
+        panel_cache[active_panel] = panel_create(active_panel);
+    }
+    else {
+        lv_obj_clear_flag(panel_cache[active_panel], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    panel_last_used[active_panel] = millis();
     lv_msg_send(DATA_PRINTER_DATA, get_current_printer());
 }
 
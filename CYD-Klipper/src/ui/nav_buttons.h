@@ -14,4 +14,8 @@ enum PANEL_TYPE {
 };
 
 void nav_buttons_setup(PANEL_TYPE active_panel);
+// Drops the cached copy of a panel so it is rebuilt the next time it is shown
+void nav_buttons_invalidate_panel(PANEL_TYPE panel);
+// Rebuilds the sidebar and all panels the next time a panel is shown
+void nav_buttons_invalidate();
 void nav_style_setup();
\ No newline at end of file
@@ -5,13 +5,21 @@
 #include "../core/data_setup.h"
 #include "../conf/global_config.h"
 #include "ota_setup.h"
-#include "../core/semaphore.h"
+#include "../core/task_layout.h"
+#include "../core/boot_timing.h"
+#include "../core/ota_download.h"
 
 //const char *ota_url = "https://gist.githubusercontent.com/suchmememanyskill/ece418fe199e155340de6c224a0badf2/raw/0d6762d68bc807cbecc71e40d55b76692397a7b3/update.json"; // Test url
-const char *ota_url = "https://suchmememanyskill.github.io/CYD-Klipper/OTA.json"; // Prod url
+// Can be pointed at a local server through build flags, see test_printer/README.md
+#ifndef OTA_URL
+#define OTA_URL "https://suchmememanyskill.github.io/CYD-Klipper/OTA.json" // Prod url
+#endif
+
+const char *ota_url = OTA_URL;
 ESP32OTAPull ota_pull;
-static bool update_available;
-static bool ready_for_ota_update = false;
+// Set from the OTA check task
+static volatile bool update_available;
+static OtaDownloadState last_download_state = OtaDownloadIdle;
 
 String ota_new_version_name()
 {
@@ -23,82 +31,140 @@ bool ota_has_update()
     return update_available;
 }
 
-static int last_callback_time = 0;
-lv_obj_t *percentage_bar;
-lv_obj_t *update_label;
-void do_update_callback(int offset, int totallength)
+void ota_start_download()
 {
-    int now = millis();
-    if (now - last_callback_time < 1000)
+    if (!update_available)
     {
         return;
     }
 
-    last_callback_time = now;
-
-    float percentage = (float)offset / (float)totallength; // 0 -> 1
-    lv_bar_set_value(percentage_bar, percentage * 100, LV_ANIM_OFF);
-    lv_label_set_text_fmt(update_label, "%d/%d bytes", offset, totallength);
+    if (ota_download_status().state == OtaDownloadReady)
+    {
+        ESP.restart();
+    }
 
-    lv_refr_now(NULL);
-    lv_timer_handler();
-    lv_task_handler();
+    ota_download_start(ota_pull.GetURL().c_str(), ota_pull.GetSha256().c_str(), ota_pull.GetSize());
 }
 
-void ota_do_update(bool variant_automatic)
+void ota_status_text(char * buff)
 {
-    LOG_LN("Starting OTA Update");
-    lv_obj_clean(lv_scr_act());
+    OtaDownloadStatus status = ota_download_status();
 
-    lv_obj_t *panel = lv_create_empty_panel(lv_scr_act());
-    lv_obj_set_size(panel, CYD_SCREEN_WIDTH_PX, CYD_SCREEN_HEIGHT_PX);
-    lv_obj_align(panel, LV_ALIGN_TOP_LEFT, 0, 0);
-    lv_layout_flex_column(panel, LV_FLEX_ALIGN_CENTER);
+    switch (status.state)
+    {
+        case OtaDownloadRunning:
+            sprintf(buff, "Downloading %d%%", status.total == 0 ? 0 : (int)((unsigned long long)status.downloaded * 100 / status.total));
+            break;
+        case OtaDownloadRetrying:
+            sprintf(buff, "Retrying (%d)", status.attempt);
+            break;
+        case OtaDownloadReady:
+            sprintf(buff, "Restart to %s", ota_new_version_name().c_str());
+            break;
+        case OtaDownloadFailed:
+            sprintf(buff, "Failed, retry %s", ota_new_version_name().c_str());
+            break;
+        default:
+            sprintf(buff, "Update to %s", ota_new_version_name().c_str());
+            break;
+    }
+}
 
-    lv_obj_t *label = lv_label_create(panel);
-    lv_label_set_text(label, "Updating OTA...");
+static void btn_restart(lv_event_t * e)
+{
+    ESP.restart();
+}
 
-    percentage_bar = lv_bar_create(panel);
-    lv_obj_set_size(percentage_bar, CYD_SCREEN_WIDTH_PX - CYD_SCREEN_GAP_PX * 3, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX * 0.75f);
+// The new image is already the boot partition, declining only postpones it to the next restart
+static void ask_restart()
+{
+    lv_obj_t * root = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(root, CYD_SCREEN_WIDTH_PX - CYD_SCREEN_GAP_PX * 2, CYD_SCREEN_HEIGHT_PX - CYD_SCREEN_GAP_PX * 2);
+    lv_obj_align(root, LV_ALIGN_CENTER, 0, 0);
+    lv_layout_flex_column(root, LV_FLEX_ALIGN_SPACE_BETWEEN);
+
+    lv_obj_t * label = lv_label_create(root);
+    lv_label_set_text_fmt(label, "Update to %s is ready.\nRestart now?", ota_new_version_name().c_str());
+
+    lv_obj_t * button_row = lv_create_empty_panel(root);
+    lv_layout_flex_row(button_row, LV_FLEX_ALIGN_SPACE_BETWEEN);
+    lv_obj_set_size(button_row, lv_pct(100), CYD_SCREEN_MIN_BUTTON_HEIGHT_PX);
+
+    lv_obj_t * later_btn = lv_btn_create(button_row);
+    lv_obj_add_event_cb(later_btn, destroy_event_user_data, LV_EVENT_CLICKED, root);
+    lv_obj_set_height(later_btn, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX);
+    lv_obj_set_style_pad_all(later_btn, CYD_SCREEN_GAP_PX, 0);
+
+    label = lv_label_create(later_btn);
+    lv_label_set_text(label, "Later");
+    lv_obj_center(label);
+
+    lv_obj_t * restart_btn = lv_btn_create(button_row);
+    lv_obj_add_event_cb(restart_btn, btn_restart, LV_EVENT_CLICKED, NULL);
+    lv_obj_set_height(restart_btn, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX);
+    lv_obj_set_style_pad_all(restart_btn, CYD_SCREEN_GAP_PX, 0);
+
+    label = lv_label_create(restart_btn);
+    lv_label_set_text(label, "Restart");
+    lv_obj_center(label);
+}
 
-    update_label = lv_label_create(panel);
-    lv_label_set_text(update_label, "0/0");
+void ota_loop()
+{
+    OtaDownloadState state = ota_download_status().state;
 
-    if (!variant_automatic) {
-        LOG_LN("Freezing Background Tasks");
-        screen_timer_wake();
-        screen_timer_stop();
-        freeze_request_thread();
+    if (state == last_download_state)
+    {
+        return;
     }
 
-    lv_refr_now(NULL);
-    lv_timer_handler();
-    lv_task_handler();
+    last_download_state = state;
+
+    if (state == OtaDownloadReady)
+    {
+        if (global_config.auto_ota_update)
+        {
+            LOG_LN("OTA: Restarting into the new firmware");
+            ESP.restart();
+        }
 
-    ota_pull.SetCallback(do_update_callback);
-    ota_pull.CheckForOTAUpdate(ota_url, REPO_VERSION, ESP32OTAPull::ActionType::UPDATE_AND_BOOT);
+        screen_timer_wake();
+        ask_restart();
+    }
+    else if (state == OtaDownloadFailed)
+    {
+        lv_create_popup_message("Firmware update failed", 3000);
+    }
 }
 
-void ota_init()
+static void ota_check_task(void * param)
 {
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
     //ota_pull.AllowDowngrades(true);
     int result = ota_pull.CheckForOTAUpdate(ota_url, REPO_VERSION, ESP32OTAPull::ActionType::DONT_DO_UPDATE);
     LOG_F(("OTA Update Result: %d\n", result))
     update_available = result == ESP32OTAPull::UPDATE_AVAILABLE;
+    boot_mark(BootStageOtaCheck);
 
     if (global_config.auto_ota_update && update_available)
     {
-        ota_do_update(true);
+        ota_start_download();
     }
-}
 
-void set_ready_for_ota_update()
-{
-    ready_for_ota_update = true;
+    vTaskDelete(NULL);
 }
 
-bool is_ready_for_ota_update()
+// Checks in the background, a slow or missing uplink no longer holds up the UI
+void ota_init()
 {
-    return ready_for_ota_update;
-}
+    if (global_config.wifi_configuration_skipped)
+    {
+        return;
+    }
 
+    xTaskCreatePinnedToCore(ota_check_task, "ota_check", TASK_OTA_STACK, NULL, TASK_OTA_PRIORITY, NULL, TASK_OTA_CORE);
+}
@@ -2,7 +2,10 @@
 
 String ota_new_version_name();
 bool ota_has_update();
-void ota_do_update(bool variant_automatic = false);
+// Downloads the update in the background, the UI stays usable. Once the download is verified, restarts into it
+void ota_start_download();
+// Button text for the settings panel, buff must hold at least 32 characters
+void ota_status_text(char * buff);
 void ota_init();
-void set_ready_for_ota_update();
-bool is_ready_for_ota_update();
\ No newline at end of file
+// Called from the LVGL loop, asks to restart once a download is verified
+void ota_loop();
\ No newline at end of file
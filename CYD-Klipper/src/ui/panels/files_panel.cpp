@@ -9,6 +9,22 @@
 #include <UrlEncode.h>
 #include "../../core/printer_integration.hpp"
 
+// Only the rows in view plus this many on each side exist as widgets, they are moved and relabeled while scrolling
+#define FILES_LIST_MARGIN_ROWS 2
+#define FILES_LIST_MAX_ROWS 16
+// LVGL coordinates don't reach far enough for a large library, the scrollable content covers a window of this many rows.
+// The window moves along when scrolled close to either end of it
+#define FILES_LIST_WINDOW_ROWS 64
+
+typedef struct {
+    Files files;
+    lv_obj_t * rows[FILES_LIST_MAX_ROWS];
+    unsigned char row_count;
+    lv_coord_t row_height;
+    unsigned int window_start;
+    unsigned int window_rows;
+} FilesList;
+
 const char* selected_file = NULL;
 
 static void btn_print_file(lv_event_t * e)
@@ -19,20 +35,11 @@ static void btn_print_file(lv_event_t * e)
     current_printer_start_file(selected_file);
 }
 
-static void btn_print_file_verify_instant(lv_event_t * e)
-{
-    lv_obj_t * btn = lv_event_get_target(e);
-    selected_file = (char*)lv_event_get_user_data(e);
-    current_printer_start_file(selected_file);
-}
-
-static void btn_print_file_verify(lv_event_t * e)
+static void print_file_verify()
 {
     if (get_current_printer_data()->state != PrinterState::PrinterStateIdle){
         return;
     }
-
-    selected_file = (char*)lv_event_get_user_data(e);
     
     lv_obj_t * panel = lv_obj_create(lv_scr_act());
     lv_obj_set_style_pad_hor(panel, CYD_SCREEN_GAP_PX * 2, 0);
@@ -105,38 +112,167 @@ static void btn_print_file_verify(lv_event_t * e)
     lv_obj_center(label);
 }
 
+static void btn_print_file_row(lv_event_t * e)
+{
+    lv_obj_t * btn = lv_event_get_target(e);
+    FilesList * files_list = (FilesList*)lv_event_get_user_data(e);
+    selected_file = files_list->files.available_files[(int)(intptr_t)lv_obj_get_user_data(btn)];
+
+    if (get_current_printer()->no_confirm_print_file)
+    {
+        current_printer_start_file(selected_file);
+    }
+    else
+    {
+        print_file_verify();
+    }
+}
+
+static void files_list_layout(lv_obj_t * list, FilesList * files_list)
+{
+    lv_coord_t scroll_y = lv_obj_get_scroll_y(list);
+    int first_visible = scroll_y / files_list->row_height;
+    int visible_rows = lv_obj_get_height(list) / files_list->row_height + 1;
+    int shift = 0;
+
+    if (first_visible < FILES_LIST_MARGIN_ROWS && files_list->window_start > 0)
+    {
+        shift = -min((int)files_list->window_start, FILES_LIST_WINDOW_ROWS / 2);
+    }
+    else if (first_visible + visible_rows > (int)files_list->window_rows - FILES_LIST_MARGIN_ROWS 
+        && files_list->window_start + files_list->window_rows < files_list->files.count)
+    {
+        shift = min((int)(files_list->files.count - files_list->window_start - files_list->window_rows), FILES_LIST_WINDOW_ROWS / 2);
+    }
+
+    if (shift != 0)
+    {
+        // The same files stay on screen, only the window they are shown in moves
+        files_list->window_start += shift;
+        scroll_y -= shift * files_list->row_height;
+        first_visible -= shift;
+        lv_obj_scroll_to_y(list, scroll_y, LV_ANIM_OFF);
+    }
+
+    int first_row = max(first_visible - FILES_LIST_MARGIN_ROWS, 0);
+
+    for (int i = 0; i < files_list->row_count; i++)
+    {
+        lv_obj_t * row = files_list->rows[i];
+        unsigned int window_row = first_row + i;
+        unsigned int file_index = files_list->window_start + window_row;
+
+        if (window_row >= files_list->window_rows || file_index >= files_list->files.count)
+        {
+            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_y(row, window_row * files_list->row_height);
+
+        if ((unsigned int)(uintptr_t)lv_obj_get_user_data(row) != file_index)
+        {
+            lv_obj_set_user_data(row, (void*)file_index);
+            lv_label_set_text(lv_obj_get_child(row, 1), files_list->files.available_files[file_index]);
+        }
+    }
+}
+
+static void files_list_scroll(lv_event_t * e)
+{
+    files_list_layout(lv_event_get_target(e), (FilesList*)lv_event_get_user_data(e));
+}
+
+static void free_files(Files * files)
+{
+    for (int i = 0; !files->names_borrowed && i < files->count; i++)
+    {
+        free(files->available_files[i]);
+    }
+
+    free(files->available_files);
+}
+
+static void files_list_free(lv_event_t * e)
+{
+    FilesList * files_list = (FilesList*)lv_event_get_user_data(e);
+    free_files(&files_list->files);
+    free(files_list);
+}
+
+// Dropped from the panel cache, or the whole UI is rebuilt
+static void files_panel_delete(lv_event_t * e)
+{
+    get_current_printer()->stop_watching_files();
+}
+
 void files_panel_init(lv_obj_t* panel){
+    lv_obj_add_event_cb(panel, files_panel_delete, LV_EVENT_DELETE, NULL);
     Files files = current_printer_get_files();
+    FilesList * files_list = files.success && files.count > 0 ? (FilesList*)malloc(sizeof(FilesList)) : NULL;
 
-    if (!files.success || files.count <= 0){
+    if (files_list == NULL){
+        free_files(&files);
         lv_obj_t * label = lv_label_create(panel);
         lv_label_set_text(label, "Failed to read files.");
         lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
         return;
     }
 
+    memset(files_list, 0, sizeof(FilesList));
+    files_list->files = files;
+    files_list->row_height = CYD_SCREEN_MIN_BUTTON_HEIGHT_PX * (global_config.full_filenames ? 2 : 1);
+    files_list->window_rows = min(files.count, (unsigned int)FILES_LIST_WINDOW_ROWS);
+
     lv_obj_t * list = lv_list_create(panel);
     lv_obj_set_style_radius(list, 0, 0);
     lv_obj_set_style_border_width(list, 0, 0); 
     lv_obj_set_style_bg_opa(list, LV_OPA_TRANSP, 0); 
+    lv_obj_set_style_pad_all(list, 0, 0);
+    // Rows are placed by files_list_layout
+    lv_obj_set_style_layout(list, 0, 0);
     lv_obj_set_size(list, CYD_SCREEN_PANEL_WIDTH_PX, CYD_SCREEN_PANEL_HEIGHT_PX);
     lv_obj_align(list, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_add_event_cb(list, files_list_free, LV_EVENT_DELETE, files_list);
+    lv_obj_add_event_cb(list, files_list_scroll, LV_EVENT_SCROLL, files_list);
 
-    for (int i = 0; i < files.count; i++)
+    if (files.count > FILES_LIST_WINDOW_ROWS)
     {
-        lv_obj_t * btn = lv_list_add_btn(list, LV_SYMBOL_FILE, files.available_files[i]);
+        // It would only show the position within the window
+        lv_obj_set_scrollbar_mode(list, LV_SCROLLBAR_MODE_OFF);
+    }
+
+    // Stretches the scrollable content over the whole window
+    lv_obj_t * end_marker = lv_obj_create(list);
+    lv_obj_remove_style_all(end_marker);
+    lv_obj_set_size(end_marker, 1, 1);
+    lv_obj_set_y(end_marker, files_list->window_rows * files_list->row_height - 1);
+
+    int visible_rows = CYD_SCREEN_PANEL_HEIGHT_PX / files_list->row_height + 1;
+    files_list->row_count = min(min(visible_rows + FILES_LIST_MARGIN_ROWS * 2, FILES_LIST_MAX_ROWS), (int)files.count);
+
+    for (int i = 0; i < files_list->row_count; i++)
+    {
+        lv_obj_t * btn = lv_list_add_btn(list, LV_SYMBOL_FILE, "");
         lv_obj_set_style_bg_opa(btn, LV_OPA_TRANSP, 0);
+        lv_obj_set_size(btn, LV_PCT(100), files_list->row_height);
+        // Not a valid file index, the first layout sets the text
+        lv_obj_set_user_data(btn, (void*)UINT32_MAX);
               
         if (global_config.full_filenames)
         {
-            lv_label_set_long_mode(lv_obj_get_child(btn, 1), LV_LABEL_LONG_WRAP);
+            // Wrapped names are cut after two lines with dots, a third line would run into the next row
+            lv_obj_t * label = lv_obj_get_child(btn, 1);
+            const lv_font_t * font = lv_obj_get_style_text_font(label, LV_PART_MAIN);
+            lv_label_set_long_mode(label, LV_LABEL_LONG_DOT);
+            lv_obj_set_height(label, lv_font_get_line_height(font) * 2 + lv_obj_get_style_text_line_space(label, LV_PART_MAIN));
         }
 
-        lv_obj_add_event_cb(btn, (get_current_printer()->no_confirm_print_file) ? btn_print_file_verify_instant : btn_print_file_verify, LV_EVENT_CLICKED, (void*)(files.available_files[i]));
-        lv_obj_on_destroy_free_data(btn, files.available_files[i]);
+        lv_obj_add_event_cb(btn, btn_print_file_row, LV_EVENT_CLICKED, files_list);
+        files_list->rows[i] = btn;
     }
 
-    // Not deallocating filenames in this scope will cause double allocation, oh well.
-    // TODO: read label text
-    free(files.available_files);
-}
\ No newline at end of file
+    lv_obj_update_layout(list);
+    files_list_layout(list, files_list);
+}
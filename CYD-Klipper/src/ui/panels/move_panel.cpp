@@ -80,6 +80,7 @@ static void keyboard_cb_edit_move_increment(lv_event_t * e)
     LOG_F(("Setting increment %d %d %f\n", selected_column, selected_row, increment))
     items[selected_column][selected_row] = increment * 10;
     write_global_config();
+    nav_buttons_invalidate_panel(PANEL_MOVE);
     nav_buttons_setup(PANEL_MOVE);
 }
 
@@ -143,6 +144,11 @@ static void z_line_button_press(lv_event_t * e) {
 static void x_pos_update(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char x_pos_buff[12];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->position[0], 1))){
+        return;
+    }
+
     sprintf(x_pos_buff, "X: %.1f", get_current_printer_data()->position[0]);
     lv_label_set_text(label, x_pos_buff);
 }
@@ -150,6 +156,11 @@ static void x_pos_update(lv_event_t * e){
 static void y_pos_update(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char y_pos_buff[12];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->position[1], 1))){
+        return;
+    }
+
     sprintf(y_pos_buff, "Y: %.1f", get_current_printer_data()->position[1]);
     lv_label_set_text(label, y_pos_buff);
 }
@@ -157,6 +168,11 @@ static void y_pos_update(lv_event_t * e){
 static void z_pos_update(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char z_pos_buff[12];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->position[2], 2))){
+        return;
+    }
+
     sprintf(z_pos_buff, "Z: %.2f", get_current_printer_data()->position[2]);
     lv_label_set_text(label, z_pos_buff);
 }
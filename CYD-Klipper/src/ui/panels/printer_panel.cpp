@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include "../nav_buttons.h"
 #include "../macros.h"
+#include "../../core/reconfigure.h"
 
 const char * printer_status[] = {
     "Offline",
@@ -20,7 +21,7 @@ const static lv_point_t line_points[] = { {0, 0}, {(short int)((CYD_SCREEN_PANEL
 static void update_printer_name_text(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     BasePrinter* printer = get_printer(config_index);
     lv_label_set_text(label, printer->printer_config->printer_name[0] == 0 ? printer->printer_config->printer_host : printer->printer_config->printer_name);
 }
@@ -28,7 +29,7 @@ static void update_printer_name_text(lv_event_t * e)
 static void update_printer_status_text(lv_event_t * e) 
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
 
     if (config_index == get_current_printer_index())
@@ -43,7 +44,7 @@ static void update_printer_status_text(lv_event_t * e)
 static void update_printer_label_visible_active_printer(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
 
     if (config_index == get_current_printer_index())
     {
@@ -55,13 +56,31 @@ static void update_printer_label_visible_active_printer(lv_event_t * e)
     }
 }
 
+// Fleet updates carry the snapshot of the one printer that changed, the other printers' widgets skip them
+static bool is_fleet_update_of(lv_event_t * e, int config_index)
+{
+    const void * payload = lv_msg_get_payload(lv_event_get_msg(e));
+    return payload == NULL || payload == get_printer_data(config_index);
+}
+
+static bool is_printing(PrinterData* printer)
+{
+    return printer->state == PrinterState::PrinterStatePrinting || printer->state == PrinterState::PrinterStatePaused;
+}
+
 static void update_printer_percentage_bar(lv_event_t * e)
 {
     lv_obj_t * percentage = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
-    PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
 
-    if (printer->state == PrinterState::PrinterStatePrinting || printer->state == PrinterState::PrinterStatePaused)
+    if (!is_fleet_update_of(e, config_index))
+    {
+        return;
+    }
+
+    PrinterData* printer = get_printer_data(config_index);
+
+    if (is_printing(printer))
     {
         lv_bar_set_value(percentage, printer->print_progress * 100, LV_ANIM_OFF);
     }
@@ -74,10 +93,22 @@ static void update_printer_percentage_bar(lv_event_t * e)
 static void update_printer_percentage_text(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
-    PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (!is_fleet_update_of(e, config_index))
+    {
+        return;
+    }
+
+    PrinterData* printer = get_printer_data(config_index);
+    bool printing = is_printing(printer);
+
+    if (!lv_label_needs_update(label, lv_label_key(printing ? printer->print_progress * 100 : -1, 2)))
+    {
+        return;
+    }
 
-    if (printer->state == PrinterState::PrinterStatePrinting || printer->state == PrinterState::PrinterStatePaused)
+    if (printing)
     {
         char percentage_buffer[12];
         sprintf(percentage_buffer, "%.2f%%", printer->print_progress * 100);
@@ -89,10 +120,89 @@ static void update_printer_percentage_text(lv_event_t * e)
     }
 }
 
+static void update_printer_temperature_text(lv_event_t * e)
+{
+    lv_obj_t * label = lv_event_get_target(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (!is_fleet_update_of(e, config_index))
+    {
+        return;
+    }
+
+    PrinterData* printer = get_printer_data(config_index);
+    uint32_t key = lv_label_key(printer->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
+    key = lv_label_key(printer->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1], 0, key);
+    key = lv_label_key(printer->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed], 0, key);
+    key = lv_label_key(printer->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed], 0, key);
+
+    if (!lv_label_needs_update(label, key))
+    {
+        return;
+    }
+
+    char temp_buffer[32];
+    sprintf(temp_buffer, "E %.0f/%.0f  B %.0f/%.0f",
+        printer->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1],
+        printer->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1],
+        printer->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed],
+        printer->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
+    lv_label_set_text(label, temp_buffer);
+}
+
+static void update_printer_remaining_time_text(lv_event_t * e)
+{
+    lv_obj_t * label = lv_event_get_target(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (!is_fleet_update_of(e, config_index))
+    {
+        return;
+    }
+
+    PrinterData* printer = get_printer_data(config_index);
+    bool printing = is_printing(printer);
+
+    if (!lv_label_needs_update(label, lv_label_key(printing ? (float)((unsigned long)printer->remaining_time_s / 60) : -1)))
+    {
+        return;
+    }
+
+    if (!printing)
+    {
+        lv_label_set_text(label, "");
+        return;
+    }
+
+    char time_buffer[16];
+    unsigned long time = printer->remaining_time_s;
+    sprintf(time_buffer, "%luh%02lum left", time / 3600, (time % 3600) / 60);
+    lv_label_set_text(label, time_buffer);
+}
+
+static void update_printer_file_text(lv_event_t * e)
+{
+    lv_obj_t * label = lv_event_get_target(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (!is_fleet_update_of(e, config_index))
+    {
+        return;
+    }
+
+    PrinterData* printer = get_printer_data(config_index);
+    const char * text = is_printing(printer) ? printer->print_filename : "No print";
+
+    if (strcmp(lv_label_get_text(label), text) != 0)
+    {
+        lv_label_set_text(label, text);
+    }
+}
+
 static void update_printer_control_button_text(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
 
     if (printer->power_devices > 0 && (config_index == get_current_printer_index() || printer->state == PrinterState::PrinterStateOffline))
@@ -108,7 +218,7 @@ static void update_printer_control_button_text(lv_event_t * e)
 static void btn_set_secondary_button_text(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
 
     if (config_index == get_current_printer_index())
@@ -124,7 +234,7 @@ static void btn_set_secondary_button_text(lv_event_t * e)
 static void btn_enable_control(lv_event_t * e)
 {
     lv_obj_t * btn = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
 
     if ((config_index == get_current_printer_index() || printer->state == PrinterState::PrinterStateOffline) && printer->power_devices <= 0)
@@ -155,7 +265,7 @@ static void keyboard_callback(lv_event_t * e){
 static void btn_printer_secondary(lv_event_t * e)
 {
     lv_obj_t * btn = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     BasePrinter* printer = get_printer(config_index);
     
     if (config_index == get_current_printer_index())
@@ -165,11 +275,12 @@ static void btn_printer_secondary(lv_event_t * e)
     }
 
     global_config_delete_printer(config_index);
+    reconfigure_request(ReconfigurePrinters);
 }
 
 static void btn_printer_rename(lv_event_t * e)
 {
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     BasePrinter* printer = get_printer(config_index);
     keyboard_config = printer->printer_config;
     lv_create_keyboard_text_entry(keyboard_callback, "Rename Printer", LV_KEYBOARD_MODE_TEXT_LOWER, CYD_SCREEN_WIDTH_PX * 0.75, 24, keyboard_config->printer_name, false);
@@ -178,7 +289,7 @@ static void btn_printer_rename(lv_event_t * e)
 static void btn_printer_activate(lv_event_t * e)
 {
     lv_obj_t * label = lv_event_get_target(e);
-    int config_index = (int)lv_event_get_user_data(e);
+    int config_index = (int)(intptr_t)lv_event_get_user_data(e);
     PrinterDataMinimal* printer = get_printer_data_minimal(config_index);
     BasePrinter* printer_full = get_printer(config_index);
 
@@ -195,6 +306,7 @@ static void btn_printer_activate(lv_event_t * e)
 static void btn_printer_add(lv_event_t * e)
 {
     global_config_add_new_printer();
+    reconfigure_request(ReconfigurePrinters);
 }
 
 void create_printer_ui(int index, lv_obj_t * root)
@@ -217,6 +329,27 @@ void create_printer_ui(int index, lv_obj_t * root)
     lv_obj_add_event_cb(label, update_printer_status_text, LV_EVENT_MSG_RECEIVED, (void*)index);
     lv_msg_subsribe_obj(DATA_PRINTER_MINIMAL, label, (void*)index);
 
+    lv_obj_t * fleet_row = lv_create_empty_panel(root);
+    lv_layout_flex_row(fleet_row, LV_FLEX_ALIGN_SPACE_BETWEEN);
+    lv_obj_set_size(fleet_row, width, LV_SIZE_CONTENT);
+
+    label = lv_label_create(fleet_row);
+    lv_obj_set_style_text_font(label, &CYD_SCREEN_FONT_SMALL, 0);
+    lv_obj_add_event_cb(label, update_printer_temperature_text, LV_EVENT_MSG_RECEIVED, (void*)index);
+    lv_msg_subsribe_obj(DATA_PRINTER_FLEET, label, (void*)index);
+
+    label = lv_label_create(fleet_row);
+    lv_obj_set_style_text_font(label, &CYD_SCREEN_FONT_SMALL, 0);
+    lv_obj_add_event_cb(label, update_printer_remaining_time_text, LV_EVENT_MSG_RECEIVED, (void*)index);
+    lv_msg_subsribe_obj(DATA_PRINTER_FLEET, label, (void*)index);
+
+    label = lv_label_create(root);
+    lv_obj_set_width(label, width);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_DOT);
+    lv_obj_set_style_text_font(label, &CYD_SCREEN_FONT_SMALL, 0);
+    lv_obj_add_event_cb(label, update_printer_file_text, LV_EVENT_MSG_RECEIVED, (void*)index);
+    lv_msg_subsribe_obj(DATA_PRINTER_FLEET, label, (void*)index);
+
     lv_obj_t * progress_row = lv_create_empty_panel(root);
     lv_layout_flex_row(progress_row);
     lv_obj_set_size(progress_row, width, LV_SIZE_CONTENT);
@@ -224,12 +357,12 @@ void create_printer_ui(int index, lv_obj_t * root)
     lv_obj_t * progress_bar = lv_bar_create(progress_row);
     lv_obj_set_flex_grow(progress_bar, 1);
     lv_obj_add_event_cb(progress_bar, update_printer_percentage_bar, LV_EVENT_MSG_RECEIVED, (void*)index);
-    lv_msg_subsribe_obj(DATA_PRINTER_MINIMAL, progress_bar, (void*)index);
+    lv_msg_subsribe_obj(DATA_PRINTER_FLEET, progress_bar, (void*)index);
 
     label = lv_label_create(progress_row);
     lv_obj_set_style_text_font(label, &CYD_SCREEN_FONT_SMALL, 0);
     lv_obj_add_event_cb(label, update_printer_percentage_text, LV_EVENT_MSG_RECEIVED, (void*)index);
-    lv_msg_subsribe_obj(DATA_PRINTER_MINIMAL, label, (void*)index);
+    lv_msg_subsribe_obj(DATA_PRINTER_FLEET, label, (void*)index);
 
     lv_obj_t * button_row = lv_create_empty_panel(root);
     lv_layout_flex_row(button_row);
@@ -296,4 +429,5 @@ void printer_panel_init(lv_obj_t* panel)
 
     lv_obj_set_size(lv_create_empty_panel(inner_panel), 0, 0);
     lv_msg_send(DATA_PRINTER_MINIMAL, NULL);
+    lv_msg_send(DATA_PRINTER_FLEET, NULL);
 }
\ No newline at end of file
@@ -21,17 +21,53 @@ static void progress_bar_update(lv_event_t* e){
 
 static void update_printer_data_elapsed_time(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->elapsed_time_s))){
+        return;
+    }
+
     lv_label_set_text(label, time_display(get_current_printer_data()->elapsed_time_s));
 }
 
 static void update_printer_data_remaining_time(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->remaining_time_s))){
+        return;
+    }
+
     lv_label_set_text(label, time_display(get_current_printer_data()->remaining_time_s));
 }
 
 static void update_printer_data_stats(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char buff[256] = {0};
+    PrinterData* data = get_current_printer_data();
+    uint32_t key = lv_label_key(get_current_printer()->printer_config->show_stats_on_progress_panel);
+    key = lv_label_key(data->current_layer, 0, key);
+    key = lv_label_key(data->total_layers, 0, key);
+
+    if (get_current_printer()->printer_config->show_stats_on_progress_panel != SHOW_STATS_ON_PROGRESS_PANEL_LAYER)
+    {
+        key = lv_label_key(data->position[0], 2, key);
+        key = lv_label_key(data->position[1], 2, key);
+        key = lv_label_key(data->feedrate_mm_per_s, 0, key);
+        key = lv_label_key(data->filament_used_mm / 1000, 2, key);
+    }
+
+    if (get_current_printer()->printer_config->show_stats_on_progress_panel == SHOW_STATS_ON_PROGRESS_PANEL_ALL)
+    {
+        key = lv_label_key(data->pressure_advance, 3, key);
+        key = lv_label_key(data->smooth_time, 2, key);
+        key = lv_label_key(data->position[2], 2, key);
+        key = lv_label_key(data->fan_speed * 100, 0, key);
+        key = lv_label_key(data->speed_mult * 100, 0, key);
+        key = lv_label_key(data->extrude_mult * 100, 0, key);
+    }
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
 
     switch (get_current_printer()->printer_config->show_stats_on_progress_panel)
     {
@@ -54,6 +90,11 @@ static void update_printer_data_stats(lv_event_t * e){
 static void update_printer_data_percentage(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char percentage_buffer[12];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->print_progress * 100, 2))){
+        return;
+    }
+
     sprintf(percentage_buffer, "%.2f%%", get_current_printer_data()->print_progress * 100);
     lv_label_set_text(label, percentage_buffer);
 }
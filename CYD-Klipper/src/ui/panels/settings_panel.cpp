@@ -9,6 +9,7 @@
 #include "../ota_setup.h"
 #include "../nav_buttons.h"
 #include "../../core/printer_integration.hpp"
+#include "../../core/reconfigure.h"
 
 #ifndef REPO_VERSION
     #define REPO_VERSION "Unknown"
@@ -25,7 +26,7 @@ static void invert_color_switch(lv_event_t * e){
 static void reset_calibration_click(lv_event_t * e){
     global_config.screen_calibrated = false;
     write_global_config();
-    ESP.restart();
+    reconfigure_request(ReconfigureDisplay);
 }
 
 static void reset_click(lv_event_t * e){
@@ -36,13 +37,13 @@ static void reset_wifi_click(lv_event_t * e){
     global_config.wifi_configured = false;
     global_config.wifi_configuration_skipped = false;
     write_global_config();
-    ESP.restart();
+    reconfigure_request(ReconfigureWifi);
 }
 
 static void reset_ip_click(lv_event_t * e){
     get_current_printer()->printer_config->setup_complete = false;
     write_global_config();
-    ESP.restart();
+    reconfigure_request(ReconfigurePrinters);
 }
 
 static void light_mode_switch(lv_event_t * e){
@@ -145,7 +146,7 @@ static void rotate_screen_switch(lv_event_t* e){
     global_config.rotate_screen = checked;
     global_config.screen_calibrated = false;
     write_global_config();
-    ESP.restart();
+    reconfigure_request(ReconfigureDisplay);
 }
 
 static void on_during_print_switch(lv_event_t* e){
@@ -157,7 +158,17 @@ static void on_during_print_switch(lv_event_t* e){
 }
 
 static void btn_ota_do_update(lv_event_t * e){
-    set_ready_for_ota_update();
+    ota_start_download();
+}
+
+static void ota_status_timer(lv_timer_t * timer){
+    char buff[32];
+    ota_status_text(buff);
+    lv_label_set_text((lv_obj_t *)timer->user_data, buff);
+}
+
+static void on_ota_button_delete(lv_event_t * e){
+    lv_timer_del((lv_timer_t *)lv_event_get_user_data(e));
 }
 
 static void auto_ota_update_switch(lv_event_t* e){
@@ -293,9 +304,13 @@ void settings_section_device(lv_obj_t* panel)
         lv_obj_add_event_cb(btn, btn_ota_do_update, LV_EVENT_CLICKED, NULL);
 
         lv_obj_t *label = lv_label_create(btn);
-        lv_label_set_text_fmt(label, "Update to %s", ota_new_version_name().c_str());
         lv_obj_center(label);
 
+        // Follows the background download while the panel is open
+        lv_timer_t *timer = lv_timer_create(ota_status_timer, 500, label);
+        lv_obj_add_event_cb(btn, on_ota_button_delete, LV_EVENT_DELETE, timer);
+        ota_status_timer(timer);
+
         lv_create_custom_menu_entry("Device", btn, panel);
     }
     else {
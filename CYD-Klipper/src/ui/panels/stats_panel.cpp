@@ -28,6 +28,13 @@ void create_state_button(lv_obj_t * root, lv_event_cb_t label, lv_event_cb_t but
 static void label_pos(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char x_pos_buff[32];
+    uint32_t key = lv_label_key(get_current_printer_data()->position[0], 2);
+    key = lv_label_key(get_current_printer_data()->position[1], 2, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
+
     sprintf(x_pos_buff, "X%.2f Y%.2f", get_current_printer_data()->position[0], get_current_printer_data()->position[1]);
     lv_label_set_text(label, x_pos_buff);
 }
@@ -35,6 +42,11 @@ static void label_pos(lv_event_t * e){
 static void label_filament_used_m(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char filament_buff[32];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->filament_used_mm / 1000, 2))){
+        return;
+    }
+
     sprintf(filament_buff, "%.2f m", get_current_printer_data()->filament_used_mm / 1000);
     lv_label_set_text(label, filament_buff);
 }
@@ -42,6 +54,13 @@ static void label_filament_used_m(lv_event_t * e){
 static void label_total_layers(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char layers_buff[32];
+    uint32_t key = lv_label_key(get_current_printer_data()->current_layer);
+    key = lv_label_key(get_current_printer_data()->total_layers, 0, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
+
     sprintf(layers_buff, "%d of %d", get_current_printer_data()->current_layer, get_current_printer_data()->total_layers);
     lv_label_set_text(label, layers_buff);
 }
@@ -49,6 +68,13 @@ static void label_total_layers(lv_event_t * e){
 static void label_pressure_advance(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char pressure_buff[32];
+    uint32_t key = lv_label_key(get_current_printer_data()->pressure_advance, 3);
+    key = lv_label_key(get_current_printer_data()->smooth_time, 2, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
+
     sprintf(pressure_buff, "%.3f (%.2fs)", get_current_printer_data()->pressure_advance, get_current_printer_data()->smooth_time);
     lv_label_set_text(label, pressure_buff);
 }
@@ -56,6 +82,11 @@ static void label_pressure_advance(lv_event_t * e){
 static void label_feedrate(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char feedrate_buff[32];
+
+    if (!lv_label_needs_update(label, lv_label_key(get_current_printer_data()->feedrate_mm_per_s))){
+        return;
+    }
+
     sprintf(feedrate_buff, "%d mm/s", get_current_printer_data()->feedrate_mm_per_s);
     lv_label_set_text(label, feedrate_buff);
 }
@@ -4,6 +4,8 @@
 #include "../ui_utils.h"
 #include "../../core/printer_integration.hpp"
 #include "../../core/current_printer.h"
+#include "../../core/temperature_history.h"
+#include "../../core/sliding_max.h"
 
 enum temp_target{
     TARGET_HOTEND,
@@ -25,6 +27,13 @@ lv_obj_t* root_panel;
 static void update_printer_data_hotend_temp(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char hotend_buff[40];
+    uint32_t key = lv_label_key(get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
+    key = lv_label_key(get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1], 0, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
+
     sprintf(hotend_buff, "Hotend: %.0f C (Target: %.0f C)", 
         get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1], 
         get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
@@ -34,6 +43,13 @@ static void update_printer_data_hotend_temp(lv_event_t * e){
 static void update_printer_data_bed_temp(lv_event_t * e){
     lv_obj_t * label = lv_event_get_target(e);
     char bed_buff[40];
+    uint32_t key = lv_label_key(get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
+    key = lv_label_key(get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed], 0, key);
+
+    if (!lv_label_needs_update(label, key)){
+        return;
+    }
+
     sprintf(bed_buff, "Bed: %.0f C (Target: %.0f C)", 
         get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed], 
         get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
@@ -174,52 +190,146 @@ static void btn_retract(lv_event_t * e){
     current_printer_execute_feature(PrinterFeatures::PrinterFeatureRetract);
 }
 
-static void set_chart_range(lv_event_t * e) {
-    lv_obj_t * chart_obj = lv_event_get_target(e);
-    lv_chart_t * chart = (lv_chart_t *)chart_obj;
+#define TEMP_CHART_POINTS TEMPERATURE_HISTORY_POINTS
+#define TEMP_CHART_SERIES 4
+
+typedef struct {
+    lv_chart_series_t * series[TEMP_CHART_SERIES];
+    // Running maximum of every series over the shown points, sets the y range
+    SlidingMax window[TEMP_CHART_SERIES];
+    unsigned short window_sample[TEMP_CHART_SERIES][TEMP_CHART_POINTS];
+    short window_value[TEMP_CHART_SERIES][TEMP_CHART_POINTS];
+    unsigned short sample;
+    lv_coord_t range;
+    TemperatureHistoryTier tier;
+    int printer_index;
+    unsigned int history_count;
+} temp_chart_t;
+
+static void temp_chart_get_values(lv_coord_t * values){
+    PrinterData * data = get_current_printer_data();
+    values[0] = data->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1];
+    values[1] = data->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1];
+    values[2] = data->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed];
+    values[3] = data->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed];
+}
+
+// Applies the new range, or only invalidates the chart when the range stays the same
+static void temp_chart_refresh(lv_obj_t * chart, temp_chart_t * model){
     int max_temp = 0;
-    lv_chart_series_t * prev = NULL;
-    
-    do {
-        prev = lv_chart_get_series_next(chart_obj, prev);
 
-        if (prev != NULL)
-            for (int i = 0; i < chart->point_cnt; i++)
-                if (prev->y_points[i] > max_temp)
-                    max_temp = prev->y_points[i];
-        
-    } while (prev != NULL);
+    for (int i = 0; i < TEMP_CHART_SERIES; i++){
+        int series_max = sliding_max_get(&model->window[i], 0);
+
+        if (series_max > max_temp){
+            max_temp = series_max;
+        }
+    }
 
     int range = ((max_temp + 49) / 50) * 50;
 
     if (range < 100)
         range = 100;
 
-    lv_chart_set_range(chart_obj, LV_CHART_AXIS_PRIMARY_Y, 0, range);
+    if (range != model->range){
+        model->range = range;
+        lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, range);
+    }
+    else {
+        lv_chart_refresh(chart);
+    }
 }
 
-static void set_hotend_temp_chart(lv_event_t * e){
-    lv_obj_t * chart = lv_event_get_target(e);
-    lv_chart_series_t * series = (lv_chart_series_t *)lv_event_get_user_data(e);
-    lv_chart_set_next_value(chart, series, get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
+static void temp_chart_push(temp_chart_t * model, int index, unsigned short sample, lv_coord_t value){
+    // Same as lv_chart_set_next_value in shift mode, without invalidating the chart for every point
+    lv_chart_series_t * series = model->series[index];
+    series->y_points[series->start_point] = value;
+    series->start_point = (series->start_point + 1) % TEMP_CHART_POINTS;
+    sliding_max_push(&model->window[index], sample, value);
 }
 
-static void set_hotend_target_temp_chart(lv_event_t * e){
-    lv_obj_t * chart = lv_event_get_target(e);
-    lv_chart_series_t * series = (lv_chart_series_t *)lv_event_get_user_data(e);
-    lv_chart_set_next_value(chart, series, get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
+// Appends the newest count samples of the shown tier. The oldest one is repeated until at least min_points got added
+static void temp_chart_append(temp_chart_t * model, unsigned int count, unsigned int min_points){
+    short actual[TEMP_CHART_POINTS];
+    short target[TEMP_CHART_POINTS];
+    unsigned int added = 0;
+
+    for (int heater = 0; heater < TemperatureHistoryHeaterCount; heater++){
+        unsigned int read = temperature_history_read(model->printer_index, (TemperatureHistoryHeater)heater, model->tier, actual, target, count);
+        unsigned int padding = read < min_points ? min_points - read : 0;
+        added = padding + read;
+
+        for (unsigned int i = 0; i < added; i++){
+            unsigned int index = i < padding ? 0 : i - padding;
+            temp_chart_push(model, heater * 2, model->sample + i, target[index] / 10);
+            temp_chart_push(model, heater * 2 + 1, model->sample + i, actual[index] / 10);
+        }
+    }
+
+    model->sample += added;
 }
 
-static void set_bed_temp_chart(lv_event_t * e){
+// Redraws the whole chart from the history of the shown tier
+static void temp_chart_load(lv_obj_t * chart, temp_chart_t * model){
+    model->printer_index = get_current_printer_index();
+    model->history_count = temperature_history_sample_count(model->printer_index, model->tier);
+    model->sample = 0;
+    for (int i = 0; i < TEMP_CHART_SERIES; i++){
+        model->series[i]->start_point = 0;
+        sliding_max_init(&model->window[i], model->window_sample[i], model->window_value[i], TEMP_CHART_POINTS);
+    }
+
+    if (model->history_count > 0){
+        temp_chart_append(model, TEMP_CHART_POINTS, TEMP_CHART_POINTS);
+    }
+    else {
+        // Nothing recorded yet, show the current temperatures as a flat line
+        lv_coord_t values[TEMP_CHART_SERIES];
+        temp_chart_get_values(values);
+
+        for (int i = 0; i < TEMP_CHART_SERIES; i++){
+            lv_chart_set_all_value(chart, model->series[i], values[i]);
+            sliding_max_push(&model->window[i], TEMP_CHART_POINTS - 1, values[i]);
+        }
+
+        model->sample = TEMP_CHART_POINTS;
+    }
+
+    temp_chart_refresh(chart, model);
+}
+
+static void temp_chart_update(lv_event_t * e){
     lv_obj_t * chart = lv_event_get_target(e);
-    lv_chart_series_t * series = (lv_chart_series_t *)lv_event_get_user_data(e);
-    lv_chart_set_next_value(chart, series, get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
+    temp_chart_t * model = (temp_chart_t *)lv_event_get_user_data(e);
+    // Another printer is shown, its own history replaces the chart
+    if (model->printer_index != get_current_printer_index()){
+        temp_chart_load(chart, model);
+        return;
+    }
+
+    unsigned int history_count = temperature_history_sample_count(model->printer_index, model->tier);
+
+    if (history_count == model->history_count){
+        return;
+    }
+
+    // The history got reset when the printers were recreated, or the chart fell a whole window behind
+    if (history_count < model->history_count || model->history_count == 0 || history_count - model->history_count >= TEMP_CHART_POINTS){
+        temp_chart_load(chart, model);
+        return;
+    }
+
+    temp_chart_append(model, history_count - model->history_count, 0);
+    model->history_count = history_count;
+    temp_chart_refresh(chart, model);
 }
 
-static void set_bed_target_temp_chart(lv_event_t * e){
+// Tapping the chart cycles between the 2 minute, 20 minute and 2 hour history
+static void temp_chart_next_tier(lv_event_t * e){
     lv_obj_t * chart = lv_event_get_target(e);
-    lv_chart_series_t * series = (lv_chart_series_t *)lv_event_get_user_data(e);
-    lv_chart_set_next_value(chart, series, get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
+    temp_chart_t * model = (temp_chart_t *)lv_event_get_user_data(e);
+    model->tier = (TemperatureHistoryTier)((model->tier + 1) % TemperatureHistoryTierCount);
+    temp_chart_load(chart, model);
 }
 
 void create_charts(lv_obj_t * root)
@@ -228,25 +338,23 @@ void create_charts(lv_obj_t * root)
     lv_obj_t * chart = lv_chart_create(root);
     lv_obj_set_size(chart, element_width - CYD_SCREEN_MIN_BUTTON_WIDTH_PX, CYD_SCREEN_MIN_BUTTON_HEIGHT_PX * 3);
     lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    lv_chart_set_point_count(chart, 120);
+    lv_chart_set_point_count(chart, TEMP_CHART_POINTS);
     lv_obj_set_style_size(chart, 0, LV_PART_INDICATOR);
     lv_chart_set_axis_tick(chart, LV_CHART_AXIS_PRIMARY_Y, CYD_SCREEN_GAP_PX / 2, CYD_SCREEN_GAP_PX / 4, 4, 3, true, CYD_SCREEN_MIN_BUTTON_WIDTH_PX);
     lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
 
-    lv_chart_series_t * ser1 = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_ORANGE), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, ser1, get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
-    lv_chart_series_t * ser2 = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, ser2, get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1]);
-    lv_chart_series_t * ser3 = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_TEAL), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, ser3, get_current_printer_data()->target_temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
-    lv_chart_series_t * ser4 = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, ser4, get_current_printer_data()->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed]);
-
-    lv_obj_add_event_cb(chart, set_hotend_target_temp_chart, LV_EVENT_MSG_RECEIVED, ser1);
-    lv_obj_add_event_cb(chart, set_hotend_temp_chart, LV_EVENT_MSG_RECEIVED, ser2);
-    lv_obj_add_event_cb(chart, set_bed_target_temp_chart, LV_EVENT_MSG_RECEIVED, ser3);
-    lv_obj_add_event_cb(chart, set_bed_temp_chart, LV_EVENT_MSG_RECEIVED, ser4);
-    lv_obj_add_event_cb(chart, set_chart_range, LV_EVENT_MSG_RECEIVED, NULL);
+    temp_chart_t * model = (temp_chart_t *)calloc(1, sizeof(temp_chart_t));
+    lv_obj_on_destroy_free_data(chart, model);
+
+    model->series[0] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_ORANGE), LV_CHART_AXIS_PRIMARY_Y);
+    model->series[1] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
+    model->series[2] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_TEAL), LV_CHART_AXIS_PRIMARY_Y);
+    model->series[3] = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+
+    temp_chart_load(chart, model);
+
+    lv_obj_add_event_cb(chart, temp_chart_update, LV_EVENT_MSG_RECEIVED, model);
+    lv_obj_add_event_cb(chart, temp_chart_next_tier, LV_EVENT_CLICKED, model);
     lv_msg_subscribe_obj(DATA_PRINTER_DATA, chart, NULL);
 }
 
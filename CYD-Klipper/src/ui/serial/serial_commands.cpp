@@ -4,6 +4,17 @@
 #include <cstring>
 #include "../../conf/global_config.h"
 #include "../../core/printer_integration.hpp"
+#include <esp_heap_caps.h>
+#include "lvgl.h"
+#include "../../core/task_layout.h"
+#include "../../core/lv_setup.h"
+#include "../ui_benchmark.h"
+#include "../../core/request_metrics.h"
+#include "../../core/boot_timing.h"
+#include "../wifi_setup.h"
+#include "../../core/host_resolver.h"
+#include "../../core/reconfigure.h"
+#include <IPAddress.h>
 
 namespace serial_console {
 
@@ -30,12 +41,21 @@ HANDLER commandHandlers[] = {
     {"key", &key, 2},
     {"touch", &touch, 5},
     {"ssid", &ssid, 3},
+    {"staticip", &staticip, 5},
     {"ip", &ip, 3},
     {"rotation", &rotation, 2},
     {"brightness", &brightness, 2},
     {"printer", &printer, 2},
     {"debug", &debug, 2},
-    {"echo", &echo, 2}
+    {"echo", &echo, 2},
+    {"mem", &mem, 1},
+    {"tasks", &tasks, 1},
+    {"power", &power, 1},
+    {"bench", &bench, 1},
+    {"metrics", &metrics, 2},
+    {"boot", &boot, 1},
+    {"hosts", &hosts, 1},
+    {"config", &config, 1}
 };
 
 void help(String argv[])
@@ -44,10 +64,11 @@ void help(String argv[])
     Serial.println("");
     Serial.println("settings             - show current settings");
     Serial.println("sets                 - show current settings as commands for copy-paste");
-    Serial.println("erase [item]         - unconfigure parameter (key|touch|ssid|ip|all)");
+    Serial.println("erase [item]         - unconfigure parameter (key|touch|ssid|staticip|ip|all)");
     Serial.println("reset                - restart CYD-klipper");
     Serial.println("touch [xm xo ym yo]  - set touchscreen multipliers and offsets");
     Serial.println("ssid [name pass]     - set the network SSID and password to connect to");
+    Serial.println("staticip [ip gw mask dns] - use a static IP instead of DHCP");
     Serial.println("ip [address port]    - set Moonraker address");
     Serial.println("key [key]            - set the Moonraker API key");
     Serial.println("rotation [on|off]    - set rotate screen 180 degrees");
@@ -55,6 +76,15 @@ void help(String argv[])
     Serial.println("printer [num|-1]     - set active printer#; -1 for multi-printer mode off");
     Serial.println("debug [on|off]       - set printing of debug messages to serial console (not saved)");
     Serial.println("echo [on|off]        - set remote echo (eecchhoo ooffff) (not saved)");
+    Serial.println("mem                  - show heap and LVGL memory usage, including the peak usage");
+    Serial.println("tasks                - show CPU load per core over 1s, busy time and free stack per task");
+    Serial.println("power                - show time spent awake and asleep, with estimated current draw");
+    Serial.println("bench                - benchmark panel switches and data updates on the screen");
+    Serial.println("metrics [show|reset] - show or reset request timings per printer endpoint");
+    Serial.println("boot                 - show how long after power on each boot stage was reached,");
+    Serial.println("                       and how long settings changes took to apply");
+    Serial.println("hosts                - show cached printer host addresses");
+    Serial.println("config               - show how often the settings were written to flash");
     Serial.println("help                 - this help");
     Serial.println("");
     Serial.println("Settings are saved immediately but come into effect after reset");
@@ -99,6 +129,16 @@ void sets(String argv[])
         Serial.printf("erase ssid\n");
     }
 
+    if(global_config.wifi_static_ip_configured)
+    {
+        Serial.printf("staticip %s %s %s %s\n", IPAddress(global_config.wifi_static_ip).toString().c_str(), IPAddress(global_config.wifi_static_gateway).toString().c_str(),
+            IPAddress(global_config.wifi_static_subnet).toString().c_str(), IPAddress(global_config.wifi_static_dns).toString().c_str());
+    }
+    else
+    {
+        Serial.printf("erase staticip\n");
+    }
+
     if(get_current_printer_config()->ip_configured)
     {
         Serial.printf("ip %s %d\n",get_current_printer_config()->printer_host, get_current_printer_config()->klipper_port);
@@ -167,6 +207,8 @@ void settings(String argv[])
         Serial.printf("Wifi not configured\n");
     }
 
+    wifi_print_status();
+
     if(get_current_printer_config()->ip_configured)
     {
         Serial.printf("Moonraker address: %s:%d\n",get_current_printer_config()->printer_host, get_current_printer_config()->klipper_port);
@@ -214,17 +256,20 @@ void erase_one(const String arg)
         // overwrite the key to make it unrecoverable for 3rd parties
         memset(get_current_printer_config()->printer_auth,0,64);
         write_global_config();
+        reconfigure_request(ReconfigurePrinters);
     }
     else if(arg == "ip")
     {
         get_current_printer_config()->setup_complete = false;
         get_current_printer_config()->ip_configured = false;
         write_global_config();
+        reconfigure_request(ReconfigurePrinters);
     }
     else if(arg == "touch")
     {
         global_config.screen_calibrated = false;
         write_global_config();
+        reconfigure_request(ReconfigureDisplay);
     }
     else if(arg == "ssid")
     {
@@ -232,6 +277,13 @@ void erase_one(const String arg)
         // overwrite the pass to make it unrecoverable for 3rd parties 
         memset(global_config.wifi_password,0,64);
         write_global_config();
+        reconfigure_request(ReconfigureWifi);
+    }
+    else if(arg == "staticip")
+    {
+        global_config.wifi_static_ip_configured = false;
+        write_global_config();
+        reconfigure_request(ReconfigureWifi);
     }
     else
     {
@@ -252,6 +304,7 @@ void erase(String argv[])
         erase_one("ip");
         erase_one("touch");
         erase_one("ssid");
+        erase_one("staticip");
     }
 }
 
@@ -260,6 +313,7 @@ void key(String argv[])
     get_current_printer_config()->auth_configured = true;
     strncpy(get_current_printer_config()->printer_auth, argv[1].c_str(), sizeof(global_config.printer_config[0].printer_auth));
     write_global_config();
+    reconfigure_request(ReconfigurePrinters);
 }
 
 void touch(String argv[])
@@ -270,6 +324,7 @@ void touch(String argv[])
     global_config.screen_cal_y_offset = argv[4].toFloat();
     global_config.screen_calibrated = true;
     write_global_config();
+    reconfigure_request(ReconfigureDisplay);
 }
 
 void ssid(String argv[])
@@ -278,6 +333,29 @@ void ssid(String argv[])
     strncpy(global_config.wifi_password, argv[2].c_str(), sizeof(global_config.wifi_password)-1);
     global_config.wifi_configured = true;
     write_global_config();
+    reconfigure_request(ReconfigureWifi);
+}
+
+void staticip(String argv[])
+{
+    IPAddress addresses[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (!addresses[i].fromString(argv[i + 1]))
+        {
+            Serial.printf("%s is not an IPv4 address\n", argv[i + 1].c_str());
+            return;
+        }
+    }
+
+    global_config.wifi_static_ip = addresses[0];
+    global_config.wifi_static_gateway = addresses[1];
+    global_config.wifi_static_subnet = addresses[2];
+    global_config.wifi_static_dns = addresses[3];
+    global_config.wifi_static_ip_configured = true;
+    write_global_config();
+    reconfigure_request(ReconfigureWifi);
 }
 
 void ip(String argv[])
@@ -287,6 +365,7 @@ void ip(String argv[])
     get_current_printer_config()->ip_configured = true;
     get_current_printer_config()->setup_complete = true;
     write_global_config();
+    reconfigure_request(ReconfigurePrinters);
 }
 
 void rotation(String argv[])
@@ -295,11 +374,13 @@ void rotation(String argv[])
     {
         global_config.rotate_screen = true;
         write_global_config();
+        reconfigure_request(ReconfigureDisplay);
     }
     else if (argv[1] == "off")
     {
         global_config.rotate_screen = false;
         write_global_config();
+        reconfigure_request(ReconfigureDisplay);
     }
     else
     {
@@ -368,4 +449,72 @@ void echo(String argv[])
 }
 
 
+void mem(String argv[])
+{
+    Serial.printf("Internal RAM: %u free, %u lowest free, %u largest block\n",
+        heap_caps_get_free_size(MALLOC_CAP_INTERNAL), heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL), heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    Serial.printf("DMA capable RAM: %u free, %u largest block\n",
+        heap_caps_get_free_size(MALLOC_CAP_DMA), heap_caps_get_largest_free_block(MALLOC_CAP_DMA));
+
+#ifdef BOARD_HAS_PSRAM
+    Serial.printf("PSRAM: %u free, %u lowest free, %u largest block\n",
+        heap_caps_get_free_size(MALLOC_CAP_SPIRAM), heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM), heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+#endif
+
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t monitor;
+    lv_mem_monitor(&monitor);
+    Serial.printf("LVGL heap: %u of %u used (%d%%), peak %u, %u largest free block, %d%% fragmented\n",
+        monitor.total_size - monitor.free_size, monitor.total_size, monitor.used_pct, monitor.max_used, monitor.free_biggest_size, monitor.frag_pct);
+#endif
+}
+
+void tasks(String argv[])
+{
+    task_print_stats();
+}
+
+void power(String argv[])
+{
+    print_power_stats();
+}
+
+void bench(String argv[])
+{
+    ui_benchmark_run();
+}
+
+void metrics(String argv[])
+{
+    if (argv[1] == "show")
+    {
+        request_metrics_print();
+    }
+    else if (argv[1] == "reset")
+    {
+        request_metrics_reset();
+        Serial.println("Request metrics reset");
+    }
+    else
+    {
+        Serial.println("metrics can be show or reset");
+    }
+}
+
+void boot(String argv[])
+{
+    boot_print_timings();
+    reconfigure_print_timings();
+}
+
+void hosts(String argv[])
+{
+    host_resolver_print();
+}
+
+void config(String argv[])
+{
+    global_config_print_stats();
+}
+
 }
\ No newline at end of file
@@ -18,12 +18,21 @@ void erase(String argv[]);
 void key(String argv[]);
 void touch(String argv[]);
 void ssid(String argv[]);
+void staticip(String argv[]);
 void ip(String argv[]);
 void rotation(String argv[]);
 void brightness(String argv[]);
 void printer(String argv[]);
 void debug(String argv[]);
 void echo(String argv[]);
+void mem(String argv[]);
+void tasks(String argv[]);
+void power(String argv[]);
+void bench(String argv[]);
+void metrics(String argv[]);
+void boot(String argv[]);
+void hosts(String argv[]);
+void config(String argv[]);
 
 int find_command(String cmd);
 }
\ No newline at end of file
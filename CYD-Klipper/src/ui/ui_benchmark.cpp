@@ -0,0 +1,120 @@
+#include "ui_benchmark.h"
+#include "lvgl.h"
+#include "nav_buttons.h"
+#include "ui_utils.h"
+#include "../conf/global_config.h"
+#include "../core/printer_integration.hpp"
+#include "../core/lv_setup.h"
+#include <HardwareSerial.h>
+
+#define UI_BENCHMARK_UPDATES 20
+
+#ifdef UI_BENCHMARK_HOST
+// The host build talks to a mocked printer, so the panels that fetch while being built are covered too
+static const PANEL_TYPE benchmark_panels[] = { PANEL_PROGRESS, PANEL_MOVE, PANEL_TEMP, PANEL_STATS, PANEL_SETTINGS, PANEL_FILES, PANEL_MACROS };
+static const char* benchmark_panel_names[] = { "progress", "move", "temp", "stats", "settings", "files", "macros" };
+#else
+// Panels that fetch from the printer while being built are left out, they would measure the network
+static const PANEL_TYPE benchmark_panels[] = { PANEL_PROGRESS, PANEL_MOVE, PANEL_TEMP, PANEL_STATS, PANEL_SETTINGS };
+static const char* benchmark_panel_names[] = { "progress", "move", "temp", "stats", "settings" };
+#endif
+
+static unsigned long render_now_us()
+{
+    unsigned long start = micros();
+    lv_refr_now(NULL);
+    return micros() - start;
+}
+
+static unsigned int lv_heap_used()
+{
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t monitor;
+    lv_mem_monitor(&monitor);
+    return monitor.total_size - monitor.free_size;
+#else
+    return 0;
+#endif
+}
+
+// Changes the values a printer reports every second, as a real update would.
+// On the host the mocked printer is polled instead, its data takes the same path as that of a real printer
+static void fake_printer_update(PrinterData* data, int step)
+{
+#ifdef UI_BENCHMARK_HOST
+    get_current_printer()->fetch();
+    apply_printer_updates();
+#else
+    data->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexNozzle1] = 200 + step % 7;
+    data->temperatures[PrinterTemperatureDeviceIndex::PrinterTemperatureDeviceIndexBed] = 60 + step % 3;
+    data->position[0] = 100 + step;
+    data->position[1] = 100 - step;
+    data->position[2] = 0.2f * step;
+    data->print_progress = (step % 100) / 100.0f;
+    data->elapsed_time_s += 1;
+    data->printed_time_s += 1;
+    data->remaining_time_s = data->remaining_time_s > 1 ? data->remaining_time_s - 1 : 3600;
+    data->filament_used_mm += 3;
+    data->current_layer = step;
+    lv_msg_send(DATA_PRINTER_DATA, get_current_printer());
+#endif
+}
+
+void ui_benchmark_run()
+{
+    PrinterData* data = get_current_printer_data();
+    PrinterData original_data;
+    memcpy(&original_data, data, sizeof(PrinterData));
+
+    Serial.printf("UI benchmark, %d updates per panel, %dx%d\n", UI_BENCHMARK_UPDATES, CYD_SCREEN_WIDTH_PX, CYD_SCREEN_HEIGHT_PX);
+    Serial.println("panel     build ms  render ms  switch ms  update ms  update px  lvgl heap");
+
+    unsigned int heap_before = lv_heap_used();
+
+    for (int i = 0; i < sizeof(benchmark_panels) / sizeof(benchmark_panels[0]); i++)
+    {
+        PANEL_TYPE panel = benchmark_panels[i];
+
+        // Cold: build the panel from scratch and draw it
+        nav_buttons_invalidate_panel(panel);
+        unsigned long start = micros();
+        nav_buttons_setup(panel);
+        unsigned long build_us = micros() - start;
+        unsigned long render_us = render_now_us();
+
+        // Warm: switch away and back to the cached panel. Leaving settings rebuilds everything, so never go through it
+        nav_buttons_setup(panel == PANEL_STATS ? PANEL_MOVE : PANEL_STATS);
+        render_now_us();
+        start = micros();
+        nav_buttons_setup(panel);
+        unsigned long switch_us = micros() - start + render_now_us();
+
+        unsigned long long px_before = get_redrawn_px_total();
+        unsigned long update_us = 0;
+
+        for (int step = 0; step < UI_BENCHMARK_UPDATES; step++)
+        {
+            start = micros();
+            fake_printer_update(data, step);
+            update_us += micros() - start + render_now_us();
+        }
+
+        unsigned long update_px = (get_redrawn_px_total() - px_before) / UI_BENCHMARK_UPDATES;
+
+        Serial.printf("%-9s %8.1f  %9.1f  %9.1f  %9.2f  %9lu  %9u\n",
+            benchmark_panel_names[i],
+            build_us / 1000.0f,
+            render_us / 1000.0f,
+            switch_us / 1000.0f,
+            update_us / 1000.0f / UI_BENCHMARK_UPDATES,
+            update_px,
+            lv_heap_used());
+
+        memcpy(data, &original_data, sizeof(PrinterData));
+    }
+
+    Serial.printf("LVGL heap grew by %d bytes while the panels were cached\n", (int)lv_heap_used() - (int)heap_before);
+
+    lv_msg_send(DATA_PRINTER_DATA, get_current_printer());
+    lv_msg_send(DATA_PRINTER_STATE, get_current_printer());
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Scripts panel switches and printer data updates on the device, and prints render time,
+// redrawn area and LVGL heap usage per panel. Blocks the UI while running.
+// Display driver changes are compared by running it on the same board, printing, before and after.
+// With DMA flushing, render time ends once the last stripe is queued, not sent; the LVGL perf monitor
+// (REPO_DEVELOPMENT builds) shows the resulting FPS and CPU load.
+void ui_benchmark_run();
@@ -290,4 +290,40 @@ lv_obj_t * lv_label_btn_create(lv_obj_t * parent, lv_event_cb_t btn_callback, vo
 
     lv_obj_t * label = lv_label_create(panel);
     return label;
-}
\ No newline at end of file
+}
+
+uint32_t lv_label_key(float value, int decimals, uint32_t key)
+{
+    for (int i = 0; i < decimals; i++)
+    {
+        value *= 10;
+    }
+
+    int32_t rounded = lroundf(value);
+
+    // FNV-1a
+    for (int i = 0; i < 4; i++)
+    {
+        key ^= (rounded >> (i * 8)) & 0xFF;
+        key *= 16777619u;
+    }
+
+    return key;
+}
+
+bool lv_label_needs_update(lv_obj_t * label, uint32_t key)
+{
+    // A fresh label has no user data, make sure it always gets rendered once
+    if (key == 0)
+    {
+        key = 1;
+    }
+
+    if ((uint32_t)(uintptr_t)lv_obj_get_user_data(label) == key)
+    {
+        return false;
+    }
+
+    lv_obj_set_user_data(label, (void*)key);
+    return true;
+}
@@ -46,4 +46,11 @@ void lv_create_custom_menu_switch(const char *label_text, lv_obj_t* root_panel,
 void lv_create_custom_menu_dropdown(const char *label_text, lv_obj_t *root_panel, lv_event_cb_t on_change, const char *options, int index, void * user_data = NULL, const char * comment = NULL);
 void lv_create_custom_menu_label(const char *label_text, lv_obj_t* root_panel, const char *text);
 void lv_create_popup_message(const char* message, uint16_t timeout_ms);
-lv_obj_t * lv_label_btn_create(lv_obj_t * parent, lv_event_cb_t btn_callback, void* user_data = NULL);
\ No newline at end of file
+lv_obj_t * lv_label_btn_create(lv_obj_t * parent, lv_event_cb_t btn_callback, void* user_data = NULL);
+
+#define LV_LABEL_KEY_SEED 2166136261u
+// Folds a value, rounded to the amount of decimals it is displayed with, into a label key
+uint32_t lv_label_key(float value, int decimals = 0, uint32_t key = LV_LABEL_KEY_SEED);
+// Returns false when the label was last rendered from the same key, so formatting and redrawing can be skipped.
+// The key is kept in the label's user data
+bool lv_label_needs_update(lv_obj_t * label, uint32_t key);
\ No newline at end of file
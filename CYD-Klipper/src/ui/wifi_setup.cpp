@@ -8,9 +8,18 @@
 #include "serial/serial_console.h"
 #include "panels/panel.h"
 #include "../core/semaphore.h"
+#include "../core/boot_timing.h"
+#include "../core/reconfigure.h"
+#include <Preferences.h>
+
+// Without a connection after this long, a staged boot falls back to the blocking WiFi screen
+#define WIFI_BOOT_TIMEOUT_MS 20000
+// A direct connect to the cached access point that takes longer than this falls back to a full scan
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 4000
 
 void wifi_init_inner();
 void wifi_pass_entry(const char* ssid);
+static void wifi_begin();
 
 const char * current_ssid_ptr = NULL;
 
@@ -136,15 +145,7 @@ void wifi_init_inner(){
     lv_obj_clean(lv_scr_act());
 
     if (global_config.wifi_configured){
-        if (global_config.wifi_password[0] == '\0')
-        {
-            WiFi.begin(global_config.wifi_SSID);
-        }
-        else 
-        {
-            WiFi.begin(global_config.wifi_SSID, global_config.wifi_password);
-        }
-        
+        wifi_begin();
         LOG_F(("Connecting to %s with a password length of %d\n", global_config.wifi_SSID, strlen(global_config.wifi_password)))
 
         lv_obj_t * label = lv_label_create(lv_scr_act());
@@ -255,6 +256,169 @@ const char* errs[] = {
 
 const int print_freq = 1000;
 int print_timer = 0;
+static bool wifi_boot_pending = false;
+static unsigned long wifi_boot_started = 0;
+
+// The access point and lease of the last connection. Kept out of the global config, which is only written on user changes
+typedef struct {
+    char ssid[33];
+    unsigned char bssid[6];
+    unsigned char channel;
+    unsigned int ip;
+    unsigned int gateway;
+    unsigned int subnet;
+    unsigned int dns;
+} WifiCache;
+
+static WifiCache wifi_cache = {0};
+static bool wifi_cache_loaded = false;
+static bool wifi_fast_connect = false;
+static unsigned long wifi_connect_started = 0;
+static volatile bool wifi_cache_dirty = false;
+
+static bool wifi_cache_usable(){
+    if (!wifi_cache_loaded){
+        Preferences preferences;
+        if (preferences.begin("wifi_cache", true)){
+            preferences.getBytes("last", &wifi_cache, sizeof(wifi_cache));
+            preferences.end();
+        }
+
+        wifi_cache_loaded = true;
+    }
+
+    return wifi_cache.channel != 0 && strcmp(wifi_cache.ssid, global_config.wifi_SSID) == 0;
+}
+
+// Runs from the loop, flash writes do not belong in the WiFi event task
+static void wifi_cache_store(){
+    WifiCache cache = {0};
+    strcpy(cache.ssid, global_config.wifi_SSID);
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+
+    if (memcmp(&cache, &wifi_cache, sizeof(cache)) == 0){
+        return;
+    }
+
+    wifi_cache = cache;
+    Preferences preferences;
+    preferences.begin("wifi_cache", false);
+    preferences.putBytes("last", &wifi_cache, sizeof(wifi_cache));
+    preferences.end();
+    LOG_F(("Cached access point %s on channel %d\n", WiFi.BSSIDstr().c_str(), wifi_cache.channel))
+}
+
+static void wifi_cache_clear(){
+    memset(&wifi_cache, 0, sizeof(wifi_cache));
+    Preferences preferences;
+    preferences.begin("wifi_cache", false);
+    preferences.clear();
+    preferences.end();
+}
+
+static void wifi_event_got_ip(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    LOG_F(("WiFi connected after %lu ms (%s)\n", millis() - wifi_connect_started, wifi_fast_connect ? "cached access point" : "full scan"))
+    boot_note(BootStageWifi, wifi_fast_connect ? "cached access point" : "full scan");
+    boot_mark(BootStageWifi);
+    wifi_cache_dirty = true;
+    // The polling tasks idle until WiFi is up, fetch right away instead of at the next interval
+    data_poll_now();
+}
+
+// WiFi is set up again when its settings change, the handler must only be registered once
+static void wifi_listen_for_ip()
+{
+    static bool listening = false;
+
+    if (!listening)
+    {
+        WiFi.onEvent(wifi_event_got_ip, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+        listening = true;
+    }
+}
+
+// Connects straight to the last access point when it is known, skipping the scan over all channels
+static void wifi_begin()
+{
+    const char* password = global_config.wifi_password[0] == '\0' ? NULL : global_config.wifi_password;
+
+    if (global_config.wifi_static_ip_configured)
+    {
+        WiFi.config(IPAddress(global_config.wifi_static_ip), IPAddress(global_config.wifi_static_gateway),
+            IPAddress(global_config.wifi_static_subnet), IPAddress(global_config.wifi_static_dns));
+    }
+    else
+    {
+        // Back to DHCP, a static address may have been set before the settings changed
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
+
+    boot_mark(BootStageWifiStart);
+    wifi_fast_connect = wifi_cache_usable();
+    wifi_connect_started = millis();
+
+    if (wifi_fast_connect)
+    {
+        WiFi.begin(global_config.wifi_SSID, password, wifi_cache.channel, wifi_cache.bssid);
+    }
+    else 
+    {
+        WiFi.begin(global_config.wifi_SSID, password);
+    }
+}
+
+// The access point may have moved to another channel, or the network may be served by another one now
+static void wifi_check_fast_connect(){
+    if (!wifi_fast_connect || WiFi.status() == WL_CONNECTED || millis() - wifi_connect_started < WIFI_FAST_CONNECT_TIMEOUT_MS){
+        return;
+    }
+
+    LOG_LN("Cached access point did not answer, scanning");
+    wifi_cache_clear();
+    WiFi.disconnect();
+    wifi_begin();
+}
+
+void wifi_print_status(){
+    if (WiFi.status() == WL_CONNECTED){
+        Serial.printf("WiFi: connected to %s on channel %d, ip %s (%s)\n", WiFi.BSSIDstr().c_str(), WiFi.channel(),
+            WiFi.localIP().toString().c_str(), global_config.wifi_static_ip_configured ? "static" : "dhcp");
+    }
+    else {
+        Serial.printf("WiFi: not connected\n");
+    }
+
+    if (wifi_cache_usable()){
+        Serial.printf("WiFi: cached access point on channel %d, last ip %s\n", wifi_cache.channel, IPAddress(wifi_cache.ip).toString().c_str());
+    }
+}
+
+bool wifi_init_async(){
+    if (global_config.wifi_configuration_skipped)
+    {
+        return true;
+    }
+
+    // Setting up a printer tests the connection, so that still needs WiFi to be up first
+    if (!global_config.wifi_configured || !global_config.printer_config[global_config.printer_index].setup_complete)
+    {
+        return false;
+    }
+
+    WiFi.mode(WIFI_STA);
+    wifi_listen_for_ip();
+    wifi_begin();
+    wifi_boot_pending = true;
+    wifi_boot_started = millis();
+    LOG_F(("Connecting to %s in the background\n", global_config.wifi_SSID))
+    return true;
+}
 
 void wifi_init(){
     if (global_config.wifi_configuration_skipped)
@@ -263,6 +427,7 @@ void wifi_init(){
     }
 
     WiFi.mode(WIFI_STA);
+    wifi_listen_for_ip();
     wifi_init_inner();
 
     while (!global_config.wifi_configuration_skipped && (!global_config.wifi_configured || WiFi.status() != WL_CONNECTED)){
@@ -271,6 +436,7 @@ void wifi_init(){
             LOG_F(("WiFi Status: %s\n", errs[WiFi.status()]))
         }
         
+        wifi_check_fast_connect();
         lv_handler();
         serial_console::run();
     }
@@ -279,6 +445,27 @@ void wifi_init(){
 ulong start_time_recovery = 0;
 
 void wifi_ok(){
+    if (wifi_cache_dirty && WiFi.status() == WL_CONNECTED){
+        wifi_cache_dirty = false;
+        wifi_cache_store();
+    }
+
+    if (wifi_boot_pending){
+        wifi_check_fast_connect();
+
+        if (WiFi.status() == WL_CONNECTED){
+            wifi_boot_pending = false;
+        }
+        else if (millis() - wifi_boot_started > WIFI_BOOT_TIMEOUT_MS){
+            // Likely wrong credentials. The blocking screen offers a way back to WiFi setup, the UI is rebuilt after
+            LOG_LN("WiFi did not connect during boot");
+            wifi_boot_pending = false;
+            reconfigure_request(ReconfigureWifi);
+        }
+
+        return;
+    }
+
     if (global_config.wifi_configured && WiFi.status() != WL_CONNECTED){
         LOG_LN("WiFi Connection Lost. Reconnecting...");
         freeze_request_thread();
@@ -286,19 +473,12 @@ void wifi_ok(){
         delay(5000); // Wait for the WiFi to disconnect
 
         start_time_recovery = millis();
-
-        if (global_config.wifi_password[0] == '\0')
-        {
-            WiFi.begin(global_config.wifi_SSID);
-        }
-        else 
-        {
-            WiFi.begin(global_config.wifi_SSID, global_config.wifi_password);
-        }
+        wifi_begin();
 
         while (WiFi.status() != WL_CONNECTED){
             delay(1000);
             LOG_F(("WiFi Status: %s\n", errs[WiFi.status()]))
+            wifi_check_fast_connect();
             if (millis() - start_time_recovery > 15000){
                 LOG_LN("WiFi Connection failed to reconnect. Restarting...");
                 ESP.restart();
@@ -1,2 +1,6 @@
 void wifi_init();
-void wifi_ok();
\ No newline at end of file
+// Starts connecting without waiting or showing anything. Returns false when WiFi has to be set up on screen first
+bool wifi_init_async();
+void wifi_ok();
+// Current connection and cached access point, for the serial console
+void wifi_print_status();
\ No newline at end of file
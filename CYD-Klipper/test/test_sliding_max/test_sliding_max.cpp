@@ -0,0 +1,218 @@
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../src/core/sliding_max.cpp"
+
+#define MAX_WINDOW 1000
+#define BENCHMARK_SERIES 4
+#define BENCHMARK_UPDATES 200000
+
+// Temperatures in degrees like the chart gets them, with the occasional jump of a heater turning on or off
+static short next_temperature(short previous)
+{
+    int value = previous + (rand() % 7) - 3;
+
+    if (rand() % 500 == 0)
+    {
+        value = rand() % 320;
+    }
+
+    return value < 0 ? 0 : (value > 320 ? 320 : value);
+}
+
+// What the chart did before: scan every stored point
+static short scan_max(const short* history, unsigned int window, short empty_value)
+{
+    short max = empty_value;
+
+    for (unsigned int i = 0; i < window; i++)
+    {
+        if (history[i] > max)
+        {
+            max = history[i];
+        }
+    }
+
+    return max;
+}
+
+static void check_against_scan(unsigned short window, unsigned short first_sample, unsigned int samples)
+{
+    static unsigned short sample_buffer[MAX_WINDOW];
+    static short value_buffer[MAX_WINDOW];
+    static short history[MAX_WINDOW];
+    SlidingMax max;
+    sliding_max_init(&max, sample_buffer, value_buffer, window);
+
+    // The chart starts out with zeroes in every point
+    for (unsigned int i = 0; i < window; i++)
+    {
+        history[i] = 0;
+    }
+
+    short value = 100;
+    unsigned short sample = first_sample;
+
+    for (unsigned int i = 0; i < samples; i++, sample++)
+    {
+        value = next_temperature(value);
+        history[i % window] = value;
+        sliding_max_push(&max, sample, value);
+
+        if (sliding_max_get(&max, 0) != scan_max(history, window, 0))
+        {
+            char message[96];
+            sprintf(message, "window %u, sample %u: %d instead of %d", window, i, sliding_max_get(&max, 0), scan_max(history, window, 0));
+            TEST_FAIL_MESSAGE(message);
+        }
+    }
+}
+
+void setUp()
+{
+    srand(1234);
+}
+
+void tearDown()
+{
+}
+
+void test_empty_returns_empty_value()
+{
+    unsigned short sample_buffer[4];
+    short value_buffer[4];
+    SlidingMax max;
+    sliding_max_init(&max, sample_buffer, value_buffer, 4);
+    TEST_ASSERT_EQUAL(-1, sliding_max_get(&max, -1));
+}
+
+void test_old_maximum_leaves_the_window()
+{
+    unsigned short sample_buffer[3];
+    short value_buffer[3];
+    SlidingMax max;
+    sliding_max_init(&max, sample_buffer, value_buffer, 3);
+
+    sliding_max_push(&max, 0, 200);
+    sliding_max_push(&max, 1, 50);
+    sliding_max_push(&max, 2, 60);
+    TEST_ASSERT_EQUAL(200, sliding_max_get(&max, 0));
+    sliding_max_push(&max, 3, 40);
+    TEST_ASSERT_EQUAL(60, sliding_max_get(&max, 0));
+    sliding_max_push(&max, 4, 30);
+    sliding_max_push(&max, 5, 20);
+    TEST_ASSERT_EQUAL(40, sliding_max_get(&max, 0));
+}
+
+void test_decreasing_run_longer_than_window()
+{
+    unsigned short sample_buffer[120];
+    short value_buffer[120];
+    SlidingMax max;
+    sliding_max_init(&max, sample_buffer, value_buffer, 120);
+
+    // A heater cooling down by a degree every sample
+    for (int i = 0; i < 400; i++)
+    {
+        sliding_max_push(&max, i, 300 - i);
+        TEST_ASSERT_EQUAL(300 - (i < 120 ? 0 : i - 119), sliding_max_get(&max, 0));
+    }
+}
+
+void test_matches_scan_with_chart_window()
+{
+    check_against_scan(120, 0, 100000);
+}
+
+void test_matches_scan_with_1000_point_window()
+{
+    check_against_scan(MAX_WINDOW, 0, 100000);
+}
+
+void test_matches_scan_when_sample_numbers_wrap()
+{
+    check_against_scan(120, 65000, 10000);
+    check_against_scan(MAX_WINDOW, 64000, 10000);
+}
+
+// Both ways of finding the y range over 4 series with 1000-point histories, as the chart does once per update
+void test_benchmark_1000_point_histories()
+{
+    static unsigned short sample_buffer[BENCHMARK_SERIES][MAX_WINDOW];
+    static short value_buffer[BENCHMARK_SERIES][MAX_WINDOW];
+    static short history[BENCHMARK_SERIES][MAX_WINDOW];
+    static short values[BENCHMARK_UPDATES];
+    SlidingMax max[BENCHMARK_SERIES];
+
+    for (int i = 0; i < BENCHMARK_SERIES; i++)
+    {
+        sliding_max_init(&max[i], sample_buffer[i], value_buffer[i], MAX_WINDOW);
+    }
+
+    values[0] = 100;
+
+    for (int i = 1; i < BENCHMARK_UPDATES; i++)
+    {
+        values[i] = next_temperature(values[i - 1]);
+    }
+
+    long long checksum_deque = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_UPDATES; i++)
+    {
+        short range = 0;
+
+        for (int series = 0; series < BENCHMARK_SERIES; series++)
+        {
+            sliding_max_push(&max[series], i, values[i] + series);
+            short series_max = sliding_max_get(&max[series], 0);
+            range = series_max > range ? series_max : range;
+        }
+
+        checksum_deque += range;
+    }
+
+    auto deque_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    long long checksum_scan = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCHMARK_UPDATES; i++)
+    {
+        short range = 0;
+
+        for (int series = 0; series < BENCHMARK_SERIES; series++)
+        {
+            history[series][i % MAX_WINDOW] = values[i] + series;
+            short series_max = scan_max(history[series], MAX_WINDOW, 0);
+            range = series_max > range ? series_max : range;
+        }
+
+        checksum_scan += range;
+    }
+
+    auto scan_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    char message[128];
+    sprintf(message, "4 x 1000 points: sliding max %.1f ns per update, full scan %.1f ns per update",
+        (double)deque_ns / BENCHMARK_UPDATES, (double)scan_ns / BENCHMARK_UPDATES);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(checksum_scan, checksum_deque);
+    TEST_ASSERT_LESS_THAN(scan_ns, deque_ns);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_returns_empty_value);
+    RUN_TEST(test_old_maximum_leaves_the_window);
+    RUN_TEST(test_decreasing_run_longer_than_window);
+    RUN_TEST(test_matches_scan_with_chart_window);
+    RUN_TEST(test_matches_scan_with_1000_point_window);
+    RUN_TEST(test_matches_scan_when_sample_numbers_wrap);
+    RUN_TEST(test_benchmark_1000_point_histories);
+    return UNITY_END();
+}
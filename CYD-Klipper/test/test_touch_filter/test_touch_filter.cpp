@@ -0,0 +1,79 @@
+#include <unity.h>
+#include "../../src/core/touch_filter.cpp"
+
+static TouchFilter filter;
+
+void setUp()
+{
+    filter = {};
+}
+
+void tearDown()
+{
+}
+
+void test_tap_while_awake_is_passed_on()
+{
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, false, false, 0));
+    TEST_ASSERT_EQUAL(TouchFilterActionPress, touch_filter_update(&filter, true, false, 10));
+    TEST_ASSERT_EQUAL(TouchFilterActionPress, touch_filter_update(&filter, true, false, 20));
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, false, false, 30));
+    TEST_ASSERT_EQUAL(TouchFilterReleased, filter.state);
+}
+
+void test_wake_tap_is_swallowed_until_release()
+{
+    TEST_ASSERT_EQUAL(TouchFilterActionWake, touch_filter_update(&filter, true, true, 0));
+
+    // The screen is awake from here on, the waking press still doesn't reach LVGL
+    for (unsigned long now = 10; now <= 500; now += 10)
+    {
+        TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, true, false, now));
+    }
+
+    TEST_ASSERT_EQUAL(TouchFilterWakePressed, filter.state);
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, false, false, 510));
+    TEST_ASSERT_EQUAL(TouchFilterWakeDebounce, filter.state);
+}
+
+void test_bounce_inside_window_is_ignored()
+{
+    touch_filter_update(&filter, true, true, 0);
+    touch_filter_update(&filter, false, false, 100);
+
+    // Bouncing contacts right after the release
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, true, false, 110));
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, false, false, 120));
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, true, false, 100 + TOUCH_WAKE_DEBOUNCE_MS - 1));
+    TEST_ASSERT_EQUAL(TouchFilterWakeDebounce, filter.state);
+}
+
+void test_press_after_window_is_passed_on()
+{
+    touch_filter_update(&filter, true, true, 0);
+    touch_filter_update(&filter, false, false, 100);
+
+    TEST_ASSERT_EQUAL(TouchFilterActionNone, touch_filter_update(&filter, false, false, 100 + TOUCH_WAKE_DEBOUNCE_MS));
+    TEST_ASSERT_EQUAL(TouchFilterReleased, filter.state);
+    TEST_ASSERT_EQUAL(TouchFilterActionPress, touch_filter_update(&filter, true, false, 100 + TOUCH_WAKE_DEBOUNCE_MS + 10));
+    TEST_ASSERT_EQUAL(TouchFilterPressed, filter.state);
+}
+
+void test_press_ending_window_is_handled_as_fresh_press()
+{
+    touch_filter_update(&filter, true, true, 0);
+    touch_filter_update(&filter, false, false, 100);
+
+    TEST_ASSERT_EQUAL(TouchFilterActionPress, touch_filter_update(&filter, true, false, 100 + TOUCH_WAKE_DEBOUNCE_MS));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_while_awake_is_passed_on);
+    RUN_TEST(test_wake_tap_is_swallowed_until_release);
+    RUN_TEST(test_bounce_inside_window_is_ignored);
+    RUN_TEST(test_press_after_window_is_passed_on);
+    RUN_TEST(test_press_ending_window_is_handled_as_fresh_press);
+    return UNITY_END();
+}
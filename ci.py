@@ -1,4 +1,4 @@
-import subprocess, os, shutil, json
+import subprocess, os, shutil, json, hashlib
 
 CYD_PORTS = [
     "esp32-3248S035C", 
@@ -60,11 +60,17 @@ def extract_commit() -> str:
 repo_version = extract_commit()
 configurations = []
 
-def add_configuration(board : str):
+def add_configuration(board : str, firmware_path : str):
+    # The device verifies the download against the hash before it boots into it
+    with open(firmware_path, "rb") as f:
+        firmware = f.read()
+
     configurations.append({
         "Board": board,
         "Version": repo_version,
-        "URL": f"https://suchmememanyskill.github.io/CYD-Klipper/out/{board}/firmware.bin"
+        "URL": f"https://suchmememanyskill.github.io/CYD-Klipper/out/{board}/firmware.bin",
+        "SHA256": hashlib.sha256(firmware).hexdigest(),
+        "Size": len(firmware)
     })
 
 if os.path.exists("out"):
@@ -92,7 +98,7 @@ for port in CYD_PORTS:
     with open(f"./_site/{port}.json", "w") as f:
         json.dump(get_manifest(port_path, port), f)
 
-    add_configuration(port)
+    add_configuration(port, f"{port_path}/firmware.bin")
 
 os.chdir(BASE_DIR)
 out_dir = "./_site/out"
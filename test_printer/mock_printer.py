@@ -0,0 +1,861 @@
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import os
+import random
+import re
+import ssl
+import struct
+import subprocess
+import time
+import zlib
+from urllib.parse import urlsplit, parse_qs, unquote
+
+# Stand-in for Moonraker, OctoPrint and a Bambu printer, serving only what CYD-Klipper uses.
+# Moonraker and OctoPrint share one HTTP port, Bambu gets an MQTT broker on 8883 (TLS).
+# With --ota-firmware, the HTTP port also serves an OTA.json and the firmware image for update tests.
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC11B65"
+
+
+class Faults:
+    def __init__(self, args):
+        self.latency_ms = args.latency
+        self.jitter_ms = args.jitter
+        self.drop_rate = args.drop
+        self.slowloris_bps = args.slowloris
+        self.target = re.compile(args.fault_target) if args.fault_target else None
+
+    def applies(self, target: str) -> bool:
+        return self.target is None or self.target.search(target) is not None
+
+    async def delay(self, target: str):
+        if not self.applies(target):
+            return
+
+        delay_ms = self.latency_ms + random.uniform(0, self.jitter_ms)
+        if delay_ms > 0:
+            await asyncio.sleep(delay_ms / 1000)
+
+    def should_drop(self, target: str) -> bool:
+        return self.applies(target) and random.random() < self.drop_rate
+
+    async def write(self, writer: asyncio.StreamWriter, data: bytes, target: str):
+        if self.slowloris_bps <= 0 or not self.applies(target):
+            writer.write(data)
+            await writer.drain()
+            return
+
+        # Trickle the response out in small chunks to exercise client read timeouts
+        chunk_size = max(1, self.slowloris_bps // 10)
+        for offset in range(0, len(data), chunk_size):
+            writer.write(data[offset:offset + chunk_size])
+            await writer.drain()
+            await asyncio.sleep(chunk_size / self.slowloris_bps)
+
+
+class Stats:
+    def __init__(self):
+        self.requests = {}
+
+    def record(self, target: str, status: int, size: int, started: float):
+        entry = self.requests.setdefault(target, {"count": 0, "errors": 0, "bytes": 0, "total_ms": 0.0, "max_ms": 0.0})
+        elapsed_ms = (time.monotonic() - started) * 1000
+        entry["count"] += 1
+        entry["bytes"] += size
+        entry["total_ms"] += elapsed_ms
+        entry["max_ms"] = max(entry["max_ms"], elapsed_ms)
+
+        if status < 0 or status >= 400:
+            entry["errors"] += 1
+
+    def print(self):
+        print(f"{'target':<40} {'count':>7} {'errors':>7} {'bytes':>10} {'avg ms':>8} {'max ms':>8}")
+        for target, entry in sorted(self.requests.items()):
+            average = entry["total_ms"] / entry["count"]
+            print(f"{target:<40} {entry['count']:>7} {entry['errors']:>7} {entry['bytes']:>10} {average:>8.1f} {entry['max_ms']:>8.1f}")
+
+
+class Printer:
+    def __init__(self, args):
+        self.state = "standby"
+        self.state_message = "Printer is ready"
+        self.filename = ""
+        self.progress = 0.0
+        self.print_time_s = args.print_time
+        self.print_duration = 0.0
+        self.total_duration = 0.0
+        self.filament_used = 0.0
+        self.total_layers = 100
+        self.nozzle = [22.0, 0.0]
+        self.bed = [22.0, 0.0]
+        self.position = [0.0, 0.0, 0.0]
+        self.homed_axes = ""
+        self.absolute = True
+        self.speed_factor = 1.0
+        self.extrude_factor = 1.0
+        self.fan_speed = 0.0
+        self.lights = {"chamber_light": "on", "work_light": "off"}
+        self.power_devices = {"printer": "on", "lights": "off"}
+        self.files = [(f"mock_print_{i:03}.gcode", time.time() - i * 3600) for i in range(args.files)]
+        self.macros = [f"MOCK_MACRO_{i}" for i in range(args.macros)]
+        self.padding = "x" * args.pad
+
+    def tick(self, dt: float):
+        for heater in (self.nozzle, self.bed):
+            target = heater[1] if heater[1] > 0 else 22.0
+            step = 3.0 * dt
+            heater[0] += max(-step, min(step, target - heater[0]))
+
+        if self.state == "printing":
+            self.total_duration += dt
+            heated = abs(self.nozzle[0] - self.nozzle[1]) < 5 and abs(self.bed[0] - self.bed[1]) < 5
+
+            if heated:
+                self.print_duration += dt
+                self.progress = min(1.0, self.print_duration / self.print_time_s)
+                self.filament_used = self.progress * 5000
+                self.position[2] = self.progress * 20
+                self.fan_speed = 1.0
+
+            if self.progress >= 1.0:
+                self.finish("complete")
+        elif self.state == "paused":
+            self.total_duration += dt
+
+    def start(self, filename: str):
+        self.filename = filename
+        self.state = "printing"
+        self.progress = 0.0
+        self.print_duration = 0.0
+        self.total_duration = 0.0
+        self.filament_used = 0.0
+        self.nozzle[1] = 210.0
+        self.bed[1] = 60.0
+        self.homed_axes = "xyz"
+
+    def finish(self, state: str):
+        self.state = state
+        self.nozzle[1] = 0.0
+        self.bed[1] = 0.0
+        self.fan_speed = 0.0
+
+    def pause(self):
+        if self.state == "printing":
+            self.state = "paused"
+
+    def resume(self):
+        if self.state == "paused":
+            self.state = "printing"
+
+    def cancel(self):
+        if self.state in ("printing", "paused"):
+            self.finish("cancelled")
+
+    def move(self, axis: str, amount: float, relative: bool):
+        index = "xyz".index(axis)
+        self.position[index] = self.position[index] + amount if relative else amount
+
+    def run_gcode(self, script: str):
+        for line in script.upper().splitlines():
+            words = line.split()
+            if not words:
+                continue
+
+            command = words[0]
+            params = {word[0]: word[1:] for word in words[1:] if len(word) > 1}
+
+            if command == "M104" and "S" in params:
+                self.nozzle[1] = float(params["S"])
+            elif command == "M140" and "S" in params:
+                self.bed[1] = float(params["S"])
+            elif command == "G28":
+                self.homed_axes = "xyz"
+                self.position = [0.0, 0.0, 0.0]
+            elif command == "G90":
+                self.absolute = True
+            elif command == "G91":
+                self.absolute = False
+            elif command in ("G0", "G1"):
+                for axis in "XYZ":
+                    if axis in params:
+                        self.move(axis.lower(), float(params[axis]), not self.absolute)
+            elif command == "M220" and "S" in params:
+                self.speed_factor = float(params["S"]) / 100
+            elif command == "M221" and "S" in params:
+                self.extrude_factor = float(params["S"]) / 100
+            elif command == "M106":
+                self.fan_speed = float(params.get("S", 255)) / 255
+            elif command == "M107":
+                self.fan_speed = 0.0
+            elif command == "PAUSE":
+                self.pause()
+            elif command == "RESUME":
+                self.resume()
+            elif command == "CANCEL_PRINT":
+                self.cancel()
+            elif command == "SET_HEATER_TEMPERATURE":
+                named = dict(word.split("=", 1) for word in words[1:] if "=" in word)
+                heater = self.bed if named.get("HEATER") == "HEATER_BED" else self.nozzle
+                heater[1] = float(named.get("TARGET", 0))
+
+    def remaining_s(self) -> float:
+        return max(0.0, self.print_time_s - self.print_duration)
+
+    # Moonraker
+
+    def moonraker_status(self, objects: list) -> dict:
+        status = {
+            "webhooks": {"state": "ready", "state_message": self.state_message},
+            "extruder": {"temperature": self.nozzle[0], "target": self.nozzle[1], "can_extrude": self.nozzle[0] > 170, "pressure_advance": 0.04, "smooth_time": 0.04},
+            "heater_bed": {"temperature": self.bed[0], "target": self.bed[1]},
+            "toolhead": {"homed_axes": self.homed_axes},
+            "gcode_move": {
+                "gcode_position": self.position + [0.0],
+                "homing_origin": [0.0, 0.0, 0.0, 0.0],
+                "absolute_coordinates": self.absolute,
+                "speed_factor": self.speed_factor,
+                "extrude_factor": self.extrude_factor,
+                "speed": 100.0,
+            },
+            "fan": {"speed": self.fan_speed},
+            "virtual_sdcard": {"progress": self.progress},
+            "print_stats": {
+                "filename": self.filename,
+                "total_duration": self.total_duration,
+                "print_duration": self.print_duration,
+                "filament_used": self.filament_used,
+                "state": self.state,
+                "info": {"total_layer": self.total_layers, "current_layer": int(self.progress * self.total_layers)},
+            },
+            "display_status": {"progress": self.progress, "message": None},
+        }
+
+        result = {key: value for key, value in status.items() if key in objects}
+        if self.padding:
+            result["mock_padding"] = {"data": self.padding}
+
+        return {"result": {"eventtime": time.monotonic(), "status": result}}
+
+    # OctoPrint
+
+    def octo_state(self) -> dict:
+        text = {"printing": "Printing", "paused": "Paused"}.get(self.state, "Operational")
+        return {
+            "text": text,
+            "flags": {
+                "cancelling": False,
+                "closedOrError": False,
+                "error": False,
+                "finishing": False,
+                "operational": True,
+                "paused": self.state == "paused",
+                "pausing": False,
+                "printing": self.state == "printing",
+                "ready": self.state not in ("printing", "paused"),
+                "resuming": False,
+                "sdReady": False,
+            },
+        }
+
+    def octo_temperature(self) -> dict:
+        return {
+            "tool0": {"actual": self.nozzle[0], "target": self.nozzle[1], "offset": 0},
+            "bed": {"actual": self.bed[0], "target": self.bed[1], "offset": 0},
+        }
+
+    def octo_job(self) -> dict:
+        return {
+            "job": {
+                "file": {"name": self.filename or None, "origin": "local"},
+                "estimatedPrintTime": self.print_time_s,
+                "filament": {"tool0": {"length": self.filament_used, "volume": 0}},
+            },
+            "progress": {
+                "completion": self.progress * 100 if self.filename else None,
+                "printTime": int(self.print_duration),
+                "printTimeLeft": int(self.remaining_s()),
+                "filepos": 0,
+            },
+            "state": self.octo_state()["text"],
+        }
+
+    # Bambu
+
+    def bambu_report(self, full: bool) -> dict:
+        gcode_state = {"printing": "RUNNING", "paused": "PAUSE", "complete": "FINISH", "cancelled": "FAILED"}.get(self.state, "IDLE")
+        report = {
+            "nozzle_temper": self.nozzle[0],
+            "nozzle_target_temper": self.nozzle[1],
+            "bed_temper": self.bed[0],
+            "bed_target_temper": self.bed[1],
+            "gcode_state": gcode_state,
+            "mc_percent": int(self.progress * 100),
+            "mc_remaining_time": int(self.remaining_s() / 60),
+            "layer_num": int(self.progress * self.total_layers),
+            "total_layer_num": self.total_layers,
+            "cooling_fan_speed": str(int(self.fan_speed * 15)),
+            "command": "push_status",
+            "msg": 0 if full else 1,
+            "sequence_id": "0",
+        }
+
+        if full:
+            report.update({
+                "print_error": 0,
+                "spd_lvl": 2,
+                "home_flag": 7 if self.homed_axes else 0,
+                "gcode_file": self.filename,
+                "big_fan1_speed": "0",
+                "big_fan2_speed": "0",
+                "ams_exist_bits": "0",
+                "lights_report": [{"node": node, "mode": mode} for node, mode in self.lights.items()],
+            })
+
+            if self.padding:
+                report["mock_padding"] = self.padding
+
+        return {"print": report}
+
+    def bambu_command(self, message: dict):
+        print_command = message.get("print", {})
+        system_command = message.get("system", {})
+        command = print_command.get("command")
+
+        if command == "pause":
+            self.pause()
+        elif command == "resume":
+            self.resume()
+        elif command == "stop":
+            self.cancel()
+        elif command == "gcode_line":
+            self.run_gcode(print_command.get("param", ""))
+
+        if system_command.get("command") == "ledctrl":
+            self.lights[system_command.get("led_node")] = system_command.get("led_mode")
+
+
+def make_png(size: int, padding: int) -> bytes:
+    # A valid size x size RGB png, optionally padded with an ancillary chunk to inflate the payload
+    def chunk(kind: bytes, data: bytes) -> bytes:
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\x00" + b"".join(bytes([(x * 8) % 256, (y * 8) % 256, 128]) for x in range(size)) for y in range(size))
+    png = b"\x89PNG\r\n\x1a\n"
+    png += chunk(b"IHDR", struct.pack(">IIBBBBB", size, size, 8, 2, 0, 0, 0))
+
+    if padding > 0:
+        png += chunk(b"mkPd", os.urandom(padding))
+
+    png += chunk(b"IDAT", zlib.compress(raw))
+    png += chunk(b"IEND", b"")
+    return png
+
+
+class OtaServer:
+    def __init__(self, args):
+        with open(args.ota_firmware, "rb") as f:
+            self.firmware = f.read()
+
+        self.version = args.ota_version
+        self.cut = args.ota_cut
+        self.range_support = not args.ota_no_range
+        self.sha256 = hashlib.sha256(self.firmware).hexdigest()
+
+        if args.ota_bad_hash:
+            self.sha256 = "0" * 64
+
+    def manifest(self, host: str) -> bytes:
+        # No Board, so every device matches
+        return json.dumps({"Configurations": [{
+            "Version": self.version,
+            "URL": f"http://{host}/firmware.bin",
+            "SHA256": self.sha256,
+            "Size": len(self.firmware),
+        }]}).encode()
+
+    async def send_firmware(self, writer: asyncio.StreamWriter, headers: dict) -> tuple:
+        start = 0
+        match = re.match(r"bytes=(\d+)-$", headers.get("range", ""))
+
+        if match and self.range_support:
+            start = int(match.group(1))
+
+        if start >= len(self.firmware):
+            writer.write(f"HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */{len(self.firmware)}\r\nContent-Length: 0\r\nConnection: close\r\n\r\n".encode())
+            await writer.drain()
+            return 416, 0
+
+        body = self.firmware[start:]
+        response = f"HTTP/1.1 {206 if start > 0 else 200} OK\r\nContent-Type: application/octet-stream\r\nContent-Length: {len(body)}\r\n"
+        if start > 0:
+            response += f"Content-Range: bytes {start}-{len(self.firmware) - 1}/{len(self.firmware)}\r\n"
+        response += "Accept-Ranges: bytes\r\nConnection: close\r\n\r\n"
+
+        # Injected disconnect: the connection closes after this many body bytes
+        if self.cut > 0:
+            body = body[:self.cut]
+
+        writer.write(response.encode())
+        for offset in range(0, len(body), 4096):
+            writer.write(body[offset:offset + 4096])
+            await writer.drain()
+
+        return (206 if start > 0 else 200), len(body)
+
+
+class HttpServer:
+    def __init__(self, printer: Printer, faults: Faults, stats: Stats, args):
+        self.printer = printer
+        self.faults = faults
+        self.stats = stats
+        self.api_key = args.api_key
+        self.thumbnail = make_png(32, args.thumbnail_pad)
+        self.ota = OtaServer(args) if args.ota_firmware else None
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        try:
+            request_line = (await reader.readline()).decode("latin-1").strip()
+            if not request_line:
+                return
+
+            method, target, _ = request_line.split(" ", 2)
+            headers = {}
+
+            while True:
+                line = (await reader.readline()).decode("latin-1").strip()
+                if not line:
+                    break
+
+                key, value = line.split(":", 1)
+                headers[key.strip().lower()] = value.strip()
+
+            body = await reader.readexactly(int(headers.get("content-length", 0)))
+            url = urlsplit(target)
+
+            if url.path == "/sockjs/websocket" and headers.get("upgrade", "").lower() == "websocket":
+                await OctoPushSocket(self.printer, self.faults).run(reader, writer, headers)
+                return
+
+            await self.respond(writer, method, url, headers, body)
+        except (ConnectionError, asyncio.IncompleteReadError, ValueError):
+            pass
+        finally:
+            writer.close()
+
+    async def respond(self, writer, method: str, url, headers: dict, body: bytes):
+        started = time.monotonic()
+        path = url.path
+        await self.faults.delay(path)
+
+        if self.faults.should_drop(path):
+            print(f"{method} {path} -> dropped")
+            self.stats.record(path, -1, 0, started)
+            return
+
+        if self.ota is not None and path == "/firmware.bin":
+            status, size = await self.ota.send_firmware(writer, headers)
+            self.stats.record(path, status, size, started)
+            print(f"{method} {path} ({headers.get('range', 'no range')}) -> {status} ({size} bytes)")
+            return
+
+        if self.api_key and headers.get("x-api-key") != self.api_key:
+            status, content_type, payload = 403, "application/json", b'{"error":"Forbidden"}'
+        elif self.ota is not None and path == "/OTA.json":
+            status, content_type, payload = 200, "application/json", self.ota.manifest(headers.get("host", ""))
+        else:
+            status, content_type, payload = self.route(method, path, parse_qs(url.query, keep_blank_values=True), body)
+
+        response = f"HTTP/1.1 {status} {'OK' if status < 400 else 'Error'}\r\n"
+        response += f"Content-Type: {content_type}\r\nContent-Length: {len(payload)}\r\nConnection: close\r\n\r\n"
+        await self.faults.write(writer, response.encode() + payload, path)
+        self.stats.record(path, status, len(payload), started)
+        print(f"{method} {path} -> {status} ({len(payload)} bytes, {(time.monotonic() - started) * 1000:.0f} ms)")
+
+    def route(self, method: str, path: str, query: dict, body: bytes):
+        printer = self.printer
+        request = json.loads(body) if body.startswith(b"{") else {}
+
+        def ok(data) -> tuple:
+            return 200, "application/json", json.dumps(data).encode()
+
+        # Moonraker
+        if path == "/printer/info":
+            return ok({"result": {"state": "ready", "state_message": printer.state_message, "hostname": "mock"}})
+        if path == "/printer/objects/query":
+            return ok(printer.moonraker_status(list(query.keys())))
+        if path == "/printer/gcode/script":
+            printer.run_gcode(query.get("script", [""])[0])
+            return ok({"result": "ok"})
+        if path == "/printer/gcode/help":
+            help_text = {"G28": "Home axes", "PAUSE": "Pause the print", "RESUME": "Resume the print"}
+            help_text.update({macro: "CYD_SCREEN_MACRO" for macro in printer.macros})
+            return ok({"result": help_text})
+        if path == "/printer/emergency_stop":
+            printer.finish("error")
+            return ok({"result": "ok"})
+        if path == "/printer/print/start":
+            printer.start(query.get("filename", [""])[0])
+            return ok({"result": "ok"})
+        if path == "/server/files/list":
+            return ok({"result": [{"path": name, "modified": modified, "size": 1024 * 1024, "permissions": "rw"} for name, modified in printer.files]})
+        if path == "/server/files/metadata":
+            return ok({"result": {"filename": query.get("filename", [""])[0], "estimated_time": printer.print_time_s}})
+        if path == "/server/files/thumbnails":
+            thumbnail = ".thumbs/" + query.get("filename", [""])[0].replace(".gcode", "-32x32.png")
+            return ok({"result": [
+                {"width": 300, "height": 300, "size": 20000, "thumbnail_path": thumbnail.replace("32x32", "300x300")},
+                {"width": 32, "height": 32, "size": len(self.thumbnail), "thumbnail_path": thumbnail},
+            ]})
+        if path.startswith("/server/files/gcodes/"):
+            return 200, "image/png", self.thumbnail
+        if path == "/machine/device_power/devices":
+            return ok({"result": {"devices": [{"device": name, "status": state, "type": "gpio"} for name, state in printer.power_devices.items()]}})
+        if path == "/machine/device_power/device":
+            device = query.get("device", [""])[0]
+            printer.power_devices[device] = query.get("action", ["off"])[0]
+            return ok({"result": {device: printer.power_devices[device]}})
+
+        # OctoPrint
+        if path == "/api/version":
+            return ok({"api": "0.1", "server": "1.10.0", "text": "OctoPrint (mock)"})
+        if path == "/api/login":
+            return ok({"name": "mock", "session": "mock-session"})
+        if path == "/api/printer" and method == "GET":
+            return ok({"state": printer.octo_state(), "temperature": printer.octo_temperature()})
+        if path == "/api/job" and method == "GET":
+            return ok(printer.octo_job())
+        if path == "/api/job":
+            command = request.get("command")
+            action = request.get("action")
+            if command == "cancel":
+                printer.cancel()
+            elif command == "pause" and action == "resume":
+                printer.resume()
+            elif command == "pause":
+                printer.pause()
+            return 204, "application/json", b""
+        if path == "/api/printer/command":
+            printer.run_gcode("\n".join(request.get("commands", [request.get("command", "")])))
+            return 204, "application/json", b""
+        if path == "/api/printer/printhead":
+            if request.get("command") == "home":
+                printer.run_gcode("G28")
+            elif request.get("command") == "jog":
+                for axis in "xyz":
+                    if axis in request:
+                        printer.move(axis, float(request[axis]), not request.get("absolute", False))
+            return 204, "application/json", b""
+        if path == "/api/printer/tool":
+            if request.get("command") == "target":
+                printer.nozzle[1] = float(request.get("targets", {}).get("tool0", 0))
+            return 204, "application/json", b""
+        if path == "/api/printer/bed":
+            printer.bed[1] = float(request.get("target", 0))
+            return 204, "application/json", b""
+        if path == "/api/connection":
+            return 204, "application/json", b""
+        if path == "/api/files":
+            return ok({"files": [{"name": name, "path": name, "origin": "local", "type": "machinecode", "date": int(modified)} for name, modified in printer.files]})
+        if path.startswith("/api/files/local/"):
+            printer.start(unquote(path[len("/api/files/local/"):]))
+            return 204, "application/json", b""
+
+        return 404, "application/json", b'{"error":"Not found"}'
+
+
+class OctoPushSocket:
+    def __init__(self, printer: Printer, faults: Faults):
+        self.printer = printer
+        self.faults = faults
+        self.throttle = 1
+        self.authenticated = False
+
+    async def send(self, writer: asyncio.StreamWriter, message: dict):
+        payload = json.dumps(message).encode()
+
+        if len(payload) < 126:
+            header = struct.pack(">BB", 0x81, len(payload))
+        elif len(payload) <= 0xFFFF:
+            header = struct.pack(">BBH", 0x81, 126, len(payload))
+        else:
+            header = struct.pack(">BBQ", 0x81, 127, len(payload))
+
+        await self.faults.write(writer, header + payload, "/sockjs/websocket")
+
+    async def receive(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        while True:
+            first, second = await reader.readexactly(2)
+            opcode = first & 0x0F
+            length = second & 0x7F
+
+            if length == 126:
+                length = struct.unpack(">H", await reader.readexactly(2))[0]
+            elif length == 127:
+                length = struct.unpack(">Q", await reader.readexactly(8))[0]
+
+            mask = await reader.readexactly(4) if second & 0x80 else b"\0\0\0\0"
+            payload = bytes(byte ^ mask[i % 4] for i, byte in enumerate(await reader.readexactly(length)))
+
+            if opcode == 0x8:
+                return
+            if opcode == 0x9:
+                writer.write(struct.pack(">BB", 0x8A, len(payload)) + payload)
+                continue
+            if opcode != 0x1:
+                continue
+
+            message = json.loads(payload)
+            if "auth" in message:
+                self.authenticated = True
+                print(f"OctoPrint push: authenticated as {message['auth'].split(':')[0]}")
+            if "throttle" in message:
+                self.throttle = max(1, int(message["throttle"]))
+
+    async def run(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter, headers: dict):
+        accept = base64.b64encode(hashlib.sha1((headers["sec-websocket-key"] + WS_GUID).encode()).digest()).decode()
+        writer.write(f"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: {accept}\r\n\r\n".encode())
+        await writer.drain()
+        print("OctoPrint push: client connected")
+
+        receiver = asyncio.ensure_future(self.receive(reader, writer))
+        printer = self.printer
+
+        try:
+            await self.send(writer, {"connected": {"version": "1.10.0", "display_version": "1.10.0"}})
+
+            while not receiver.done():
+                await asyncio.sleep(0.5 * self.throttle)
+
+                if not self.authenticated:
+                    continue
+
+                await self.faults.delay("/sockjs/websocket")
+                if self.faults.should_drop("/sockjs/websocket"):
+                    print("OctoPrint push: dropped connection")
+                    return
+
+                job = printer.octo_job()
+                temps = dict(printer.octo_temperature(), time=int(time.time()))
+                await self.send(writer, {"current": {"state": printer.octo_state(), "job": job["job"], "progress": job["progress"], "temps": [temps]}})
+        except ConnectionError:
+            pass
+        finally:
+            receiver.cancel()
+            print("OctoPrint push: client disconnected")
+
+
+class BambuBroker:
+    def __init__(self, printer: Printer, faults: Faults, stats: Stats, args):
+        self.printer = printer
+        self.faults = faults
+        self.stats = stats
+        self.serial = args.bambu_serial
+        self.access_code = args.bambu_code
+
+    @staticmethod
+    async def read_packet(reader: asyncio.StreamReader):
+        header = (await reader.readexactly(1))[0]
+        length = 0
+        for shift in range(0, 28, 7):
+            byte = (await reader.readexactly(1))[0]
+            length |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                break
+
+        return header >> 4, header & 0x0F, await reader.readexactly(length)
+
+    @staticmethod
+    def packet(kind: int, flags: int, body: bytes) -> bytes:
+        length = len(body)
+        encoded = b""
+        while True:
+            byte = length & 0x7F
+            length >>= 7
+            encoded += bytes([byte | (0x80 if length else 0)])
+            if not length:
+                break
+
+        return bytes([(kind << 4) | flags]) + encoded + body
+
+    @staticmethod
+    def read_string(body: bytes, offset: int):
+        length = struct.unpack_from(">H", body, offset)[0]
+        return body[offset + 2:offset + 2 + length].decode(), offset + 2 + length
+
+    async def publish_report(self, writer: asyncio.StreamWriter, lock: asyncio.Lock, full: bool):
+        topic = f"device/{self.serial}/report"
+        await self.faults.delay(topic)
+
+        if self.faults.should_drop(topic):
+            print("Bambu: dropped connection")
+            writer.close()
+            return
+
+        started = time.monotonic()
+        payload = json.dumps(self.printer.bambu_report(full)).encode()
+        topic_bytes = topic.encode()
+        # The periodic reporter and replies to the client share the connection, never interleave packets
+        async with lock:
+            await self.faults.write(writer, self.packet(3, 0, struct.pack(">H", len(topic_bytes)) + topic_bytes + payload), topic)
+        self.stats.record(topic, 200, len(payload), started)
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        subscribed = False
+        reporter = None
+        lock = asyncio.Lock()
+
+        async def report_loop():
+            while True:
+                await asyncio.sleep(1)
+                await self.publish_report(writer, lock, False)
+
+        async def reply(data: bytes):
+            async with lock:
+                writer.write(data)
+                await writer.drain()
+
+        try:
+            while True:
+                kind, flags, body = await self.read_packet(reader)
+
+                if kind == 1:
+                    # CONNECT: variable header is protocol name, level, flags and keepalive
+                    _, offset = self.read_string(body, 0)
+                    connect_flags = body[offset + 1]
+                    offset += 4
+                    client_id, offset = self.read_string(body, offset)
+                    username = password = None
+                    if connect_flags & 0x80:
+                        username, offset = self.read_string(body, offset)
+                    if connect_flags & 0x40:
+                        password, offset = self.read_string(body, offset)
+
+                    accepted = username == "bblp" and password == self.access_code
+                    print(f"Bambu: connect from {client_id} as {username} -> {'accepted' if accepted else 'refused'}")
+                    await reply(self.packet(2, 0, bytes([0, 0 if accepted else 5])))
+                    if not accepted:
+                        return
+                elif kind == 8:
+                    # SUBSCRIBE: packet id, then topic filters with a qos byte each
+                    packet_id = body[:2]
+                    offset = 2
+                    granted = b""
+                    while offset < len(body):
+                        topic, offset = self.read_string(body, offset)
+                        offset += 1
+                        subscribed = subscribed or topic == f"device/{self.serial}/report"
+                        granted += b"\x00" if topic == f"device/{self.serial}/report" else b"\x80"
+
+                    await reply(self.packet(9, 0, packet_id + granted))
+
+                    if subscribed and reporter is None:
+                        reporter = asyncio.ensure_future(report_loop())
+                elif kind == 3:
+                    topic, offset = self.read_string(body, 0)
+                    if (flags >> 1) & 0x03:
+                        offset += 2
+
+                    message = json.loads(body[offset:])
+                    print(f"Bambu: {topic} {json.dumps(message)}")
+                    self.printer.bambu_command(message)
+
+                    if subscribed and message.get("pushing", {}).get("command") == "pushall":
+                        await self.publish_report(writer, lock, True)
+                elif kind == 12:
+                    await reply(self.packet(13, 0, b""))
+                elif kind == 14:
+                    return
+        except (ConnectionError, asyncio.IncompleteReadError, ssl.SSLError):
+            pass
+        finally:
+            if reporter is not None:
+                reporter.cancel()
+            writer.close()
+
+
+def get_tls_context(cert_dir: str) -> ssl.SSLContext:
+    cert = os.path.join(cert_dir, "mock_printer.crt")
+    key = os.path.join(cert_dir, "mock_printer.key")
+
+    # The firmware does not verify the printer certificate, any self signed one will do
+    if not os.path.exists(cert) or not os.path.exists(key):
+        subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "3650", "-subj", "/CN=mock-printer",
+                        "-keyout", key, "-out", cert], check=True, capture_output=True)
+
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(cert, key)
+    return context
+
+
+async def simulate(printer: Printer):
+    last = time.monotonic()
+    while True:
+        await asyncio.sleep(0.25)
+        now = time.monotonic()
+        printer.tick(now - last)
+        last = now
+
+
+async def main(args, stats: Stats):
+    printer = Printer(args)
+    faults = Faults(args)
+    http = HttpServer(printer, faults, stats, args)
+    bambu = BambuBroker(printer, faults, stats, args)
+
+    if args.start_print:
+        printer.start(printer.files[0][0] if printer.files else "mock_print.gcode")
+
+    servers = [await asyncio.start_server(http.handle, args.host, args.http_port)]
+    print(f"Moonraker/OctoPrint on http://{args.host}:{args.http_port}")
+
+    if args.mqtt_port > 0:
+        servers.append(await asyncio.start_server(bambu.handle, args.host, args.mqtt_port, ssl=get_tls_context(SCRIPT_DIR)))
+        print(f"Bambu MQTT (TLS) on {args.host}:{args.mqtt_port}, serial {args.bambu_serial}, access code {args.bambu_code}")
+
+    if args.mqtt_plain_port > 0:
+        servers.append(await asyncio.start_server(bambu.handle, args.host, args.mqtt_plain_port))
+        print(f"Bambu MQTT (plain) on {args.host}:{args.mqtt_plain_port}")
+
+    try:
+        await simulate(printer)
+    finally:
+        for server in servers:
+            server.close()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Local stand-in for the printer APIs CYD-Klipper talks to")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--http-port", type=int, default=7125, help="Moonraker and OctoPrint endpoints")
+    parser.add_argument("--mqtt-port", type=int, default=8883, help="Bambu MQTT over TLS, 0 to disable")
+    parser.add_argument("--mqtt-plain-port", type=int, default=0, help="Bambu MQTT without TLS, for packet captures")
+    parser.add_argument("--api-key", default="", help="Require this X-Api-Key on every HTTP request")
+    parser.add_argument("--bambu-serial", default="MOCKSERIAL0001")
+    parser.add_argument("--bambu-code", default="12345678", help="LAN access code")
+    parser.add_argument("--start-print", action="store_true", help="Start printing the newest file on launch")
+    parser.add_argument("--print-time", type=float, default=600, help="Simulated print duration in seconds")
+    parser.add_argument("--files", type=int, default=20, help="Number of files in the file list")
+    parser.add_argument("--macros", type=int, default=4, help="Number of CYD_SCREEN_MACRO macros")
+    parser.add_argument("--pad", type=int, default=0, help="Bytes of padding added to status payloads")
+    parser.add_argument("--thumbnail-pad", type=int, default=0, help="Bytes of padding added to the 32x32 thumbnail")
+    parser.add_argument("--latency", type=float, default=0, help="Delay in ms before every response")
+    parser.add_argument("--jitter", type=float, default=0, help="Random extra delay in ms, up to this value")
+    parser.add_argument("--drop", type=float, default=0, help="Probability (0-1) a response is dropped and the connection closed")
+    parser.add_argument("--slowloris", type=int, default=0, help="Trickle responses out at this many bytes per second")
+    parser.add_argument("--fault-target", default="", help="Regex on the HTTP path or MQTT topic, faults only apply to matches")
+    parser.add_argument("--ota-firmware", default="", help="Serve this firmware.bin with an OTA.json pointing at it")
+    parser.add_argument("--ota-version", default="v99.0.0", help="Version announced in OTA.json")
+    parser.add_argument("--ota-cut", type=int, default=0, help="Close every firmware download after this many bytes")
+    parser.add_argument("--ota-no-range", action="store_true", help="Ignore Range requests on the firmware")
+    parser.add_argument("--ota-bad-hash", action="store_true", help="Announce a wrong SHA-256 in OTA.json")
+    args = parser.parse_args()
+
+    stats = Stats()
+    try:
+        asyncio.run(main(args, stats))
+    except KeyboardInterrupt:
+        stats.print()